@@ -9,6 +9,13 @@
 #include <thread>
 #include <iostream>
 #include <utility>
+#include <type_traits>
+
+// Other parts of the Async component
+#include "thread_pool.hpp"
+#include "future.hpp"
+#include "task.hpp"
+#include "parallel.hpp"
 
 // Xenon's Modules
 #include "../concepts/concepts.hpp"
@@ -16,16 +23,23 @@
 namespace xenon {
     namespace async {
 		/**
-		* @brief Runs a function in the separate thread with specified arguments and return type.
+		* @brief Runs a function on the default thread pool with specified arguments.
 		* @param func: The function itself
 		* @param args: All the args that the function accepts
-		* @note
-		* @retval None
+		* @note The arguments are copied or moved into the job, just like std::thread would do
+		* @retval A future of what the function returns
 		*/
 		template<typename F, typename... Args>
 			requires xenon::concepts::callable<F, Args...>
-		inline void run(F&& func, Args&&... args) noexcept {
-			std::thread(func, std::forward<Args>(args)...).detach();
+		inline auto run(F&& func, Args&&... args) noexcept {
+			using result_t = std::invoke_result_t<std::decay_t<F>&, std::decay_t<Args>...>;
+			xenon::async::shared_state<result_t>* state = xenon::async::shared_state<result_t>::acquire();
+			state->add_ref();
+			xenon::async::default_pool().submit([state, func = std::forward<F>(func), ... args = std::forward<Args>(args)]() mutable {
+				xenon::async::fulfil(state, func, std::move(args)...);
+				state->release();
+			});
+			return xenon::async::future<result_t>(state);
 		}
 
 		/**
@@ -34,16 +48,16 @@ namespace xenon {
 		* @param work_func: The function which accepts that something that callback_func returns
 		* @param args: All the arguments to the callback_func
 		* @note
-		* @retval None
+		* @retval A future of what work_func returns
 		*/
 		template<typename Ret, typename F, typename F_, typename... Args>
-			requires !xenon::concepts::void_<Ret> && requires(F&& func, Args&&... args) {
+			requires (!xenon::concepts::void_<Ret>) && requires(F&& func, Args&&... args) {
 				requires std::is_convertible_v<decltype(func(std::forward<Args>(args)...)), Ret>;
 			} && xenon::concepts::callable<F_, Ret>
-		inline void then(F&& callback_func, F_&& work_func, Args&&... args) noexcept {
-			xenon::async::run([=, &args...](){
-				work_func(callback_func(std::forward<Args>(args)...));
-			});
+		inline auto then(F&& callback_func, F_&& work_func, Args&&... args) noexcept {
+			return xenon::async::run([callback_func = std::forward<F>(callback_func), work_func = std::forward<F_>(work_func)](std::decay_t<Args>&&... values) mutable {
+				return work_func(static_cast<Ret>(callback_func(std::move(values)...)));
+			}, std::forward<Args>(args)...);
 		}
     } // namespace async
 } // namespace xenon
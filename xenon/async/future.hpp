@@ -0,0 +1,497 @@
+// future.hpp
+//
+// Future and promise classes that are a part of an Async module.
+
+#ifndef XENON_HG_ASYNC_FUTURE
+#define XENON_HG_ASYNC_FUTURE
+
+// Libraries
+#include <atomic>
+#include <optional>
+#include <variant>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Other parts of the Async component
+#include "thread_pool.hpp"
+
+// Xenon's Modules
+#include "../concepts/concepts.hpp"
+
+namespace xenon {
+    namespace async {
+        template<typename T>
+        class future;
+
+        template<typename T>
+        class promise;
+
+        /**
+         * @brief A type that is stored in place of void results.
+         * @note
+         */
+        template<typename T>
+        using value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        /**
+         * @brief The state that a promise and its future share. Used internally.
+         * @note   States are recycled through a per-thread free list, so a finished task gives its state to the next one instead of freeing it.
+         */
+        template<typename T>
+        class shared_state final {
+        public:
+            /**
+             * @brief How many released states each thread keeps around for reuse.
+             * @note
+             */
+            static constexpr size_t cache_capacity = 256;
+
+            /**
+             * @brief Takes a state from the calling thread's free list or allocates a new one.
+             * @note   The returned state has one reference.
+             * @retval A pending state
+             */
+            [[nodiscard]] static shared_state* acquire(void) noexcept {
+                std::vector<shared_state*>& cache = free_list().states;
+                shared_state* state;
+                if(!cache.empty()) [[likely]] {
+                    state = cache.back();
+                    cache.pop_back();
+                } else [[unlikely]]
+                    state = new shared_state();
+                state->m_refs.store(1, std::memory_order_relaxed);
+                state->m_status.store(pending, std::memory_order_relaxed);
+                return state;
+            }
+
+            void add_ref(void) noexcept {
+                m_refs.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void release(void) noexcept {
+                if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) [[unlikely]] {
+                    m_value.reset();
+                    m_continuation = job();
+                    std::vector<shared_state*>& cache = free_list().states;
+                    if(cache.size() < cache_capacity) [[likely]]
+                        cache.push_back(this);
+                    else [[unlikely]]
+                        delete this;
+                }
+            }
+
+            /**
+             * @brief Stores the value, wakes up every waiter and runs the continuation, if there is one.
+             * @note   Must be called once
+             * @param  value: Arguments to construct the value with
+             * @retval None
+             */
+            template<typename... V>
+            void set_value(V&&... value) noexcept {
+                m_value.emplace(std::forward<V>(value)...);
+                // An attached continuation means the future was consumed, so there is nobody to wake up
+                if(m_status.exchange(ready, std::memory_order_acq_rel) == attached) {
+                    job continuation = std::move(m_continuation);
+                    continuation();
+                } else
+                    m_status.notify_all();
+            }
+
+            /**
+             * @brief Attaches a callable that runs on the thread that sets the value, or right away if it's already set.
+             * @note   Only one continuation can be attached
+             * @param  continuation: The callable
+             * @retval None
+             */
+            void on_ready(job&& continuation) noexcept {
+                if(m_status.load(std::memory_order_acquire) == ready) {
+                    continuation();
+                    return;
+                }
+                m_continuation = std::move(continuation);
+                uint32_t expected = pending;
+                if(!m_status.compare_exchange_strong(expected, attached, std::memory_order_acq_rel)) {
+                    job now = std::move(m_continuation);
+                    now();
+                }
+            }
+
+            /**
+             * @brief Parks the calling thread until the value is set.
+             * @note
+             * @retval None
+             */
+            void wait(void) const noexcept {
+                for(uint32_t status = m_status.load(std::memory_order_acquire); status != ready; status = m_status.load(std::memory_order_acquire))
+                    m_status.wait(status, std::memory_order_acquire);
+            }
+
+            [[nodiscard]] bool is_ready(void) const noexcept {
+                return m_status.load(std::memory_order_acquire) == ready;
+            }
+
+            [[nodiscard]] value_t<T>& value(void) noexcept {
+                return *m_value;
+            }
+        private:
+            enum : uint32_t {
+                pending,
+                attached,
+                ready
+            };
+
+            struct cache {
+                std::vector<shared_state*> states;
+
+                ~cache(void) noexcept {
+                    for(shared_state* state : states)
+                        delete state;
+                }
+            };
+
+            static cache& free_list(void) noexcept {
+                static thread_local cache states;
+                return states;
+            }
+
+            shared_state(void) noexcept = default;
+
+            std::atomic<uint32_t> m_status = pending;
+            std::atomic<uint32_t> m_refs = 1;
+            std::optional<value_t<T>> m_value;
+            job m_continuation;
+        };
+
+        /**
+         * @brief Fulfils a state with the result of invoking the function.
+         * @note
+         * @param  state: The state
+         * @param  func: The function
+         * @param  args: All the args that the function accepts
+         * @retval None
+         */
+        template<typename R, typename F, typename... Args>
+        inline void fulfil(shared_state<R>* state, F& func, Args&&... args) noexcept {
+            if constexpr(std::is_void_v<R>) {
+                func(std::forward<Args>(args)...);
+                state->set_value();
+            } else
+                state->set_value(func(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief A result that will become available later. Move-only.
+         * @note   get() consumes the future.
+         */
+        template<typename T>
+        class future final {
+        public:
+            using value_type = T;
+
+            future(void) noexcept = default;
+
+            /**
+             * @brief Takes over a reference to a shared state. Used internally.
+             * @note
+             * @param  state: The state
+             */
+            explicit future(shared_state<T>* state) noexcept
+                : m_state(state) {}
+
+            future(future&& other) noexcept
+                : m_state(std::exchange(other.m_state, nullptr)) {}
+
+            future& operator=(future&& other) noexcept {
+                if(this != &other) [[likely]] {
+                    if(m_state)
+                        m_state->release();
+                    m_state = std::exchange(other.m_state, nullptr);
+                }
+                return *this;
+            }
+
+            future(const future&) = delete;
+            future& operator=(const future&) = delete;
+
+            ~future(void) noexcept {
+                if(m_state)
+                    m_state->release();
+            }
+
+            /**
+             * @brief Checks whether the future refers to a result.
+             * @note
+             * @retval False if it's default-constructed or was consumed
+             */
+            [[nodiscard]] bool valid(void) const noexcept {
+                return m_state != nullptr;
+            }
+
+            /**
+             * @brief Checks whether the result is available without blocking.
+             * @note
+             * @retval True if it is
+             */
+            [[nodiscard]] bool is_ready(void) const noexcept {
+                return m_state->is_ready();
+            }
+
+            /**
+             * @brief Parks the calling thread until the result is available.
+             * @note
+             * @retval None
+             */
+            void wait(void) const noexcept {
+                m_state->wait();
+            }
+
+            /**
+             * @brief Waits for the result and moves it out.
+             * @note   The future is no longer valid afterwards
+             * @retval The result
+             */
+            T get(void) noexcept {
+                m_state->wait();
+                shared_state<T>* state = std::exchange(m_state, nullptr);
+                if constexpr(std::is_void_v<T>)
+                    state->release();
+                else {
+                    T value = std::move(state->value());
+                    state->release();
+                    return value;
+                }
+            }
+
+            /**
+             * @brief Runs a function with the result on the default thread pool once it is available.
+             * @note   The future is no longer valid afterwards
+             * @param  func: The function that accepts the result(or nothing for void)
+             * @retval A future of what the function returns
+             */
+            template<typename F>
+                requires (std::is_void_v<T> && xenon::concepts::callable<F>) || xenon::concepts::callable<F, T>
+            auto then(F&& func) noexcept {
+                using result_t = decltype(invoke_with_value(func, std::declval<value_t<T>&&>()));
+                shared_state<result_t>* next = shared_state<result_t>::acquire();
+                next->add_ref();
+                on_ready([next, func = std::forward<F>(func)](value_t<T>&& value) mutable {
+                    xenon::async::default_pool().submit([next, func = std::move(func), value = std::move(value)]() mutable {
+                        if constexpr(std::is_void_v<result_t>) {
+                            invoke_with_value(func, std::move(value));
+                            next->set_value();
+                        } else
+                            next->set_value(invoke_with_value(func, std::move(value)));
+                        next->release();
+                    });
+                });
+                return future<result_t>(next);
+            }
+
+            /**
+             * @brief Calls a function with the result on whichever thread makes it available, or right away if it already is.
+             * @note   Keep the function short, it runs inline. The future is no longer valid afterwards
+             * @param  func: The function that accepts the result(std::monostate for void)
+             * @retval None
+             */
+            template<typename F>
+                requires xenon::concepts::callable<F, value_t<T>&&>
+            void on_ready(F&& func) noexcept {
+                shared_state<T>* state = std::exchange(m_state, nullptr);
+                state->on_ready([state, func = std::forward<F>(func)]() mutable {
+                    func(std::move(state->value()));
+                    state->release();
+                });
+            }
+        private:
+            template<typename F>
+            static decltype(auto) invoke_with_value(F& func, value_t<T>&& value) noexcept {
+                if constexpr(std::is_void_v<T>)
+                    return func();
+                else
+                    return func(std::move(value));
+            }
+
+            shared_state<T>* m_state = nullptr;
+        };
+
+        /**
+         * @brief The producing side of a future.
+         * @note   A promise must be fulfilled before it is destroyed, otherwise its future never becomes ready.
+         */
+        template<typename T>
+        class promise final {
+        public:
+            promise(void) noexcept
+                : m_state(shared_state<T>::acquire()) {}
+
+            promise(promise&& other) noexcept
+                : m_state(std::exchange(other.m_state, nullptr)) {}
+
+            promise& operator=(promise&& other) noexcept {
+                if(this != &other) [[likely]] {
+                    if(m_state)
+                        m_state->release();
+                    m_state = std::exchange(other.m_state, nullptr);
+                }
+                return *this;
+            }
+
+            promise(const promise&) = delete;
+            promise& operator=(const promise&) = delete;
+
+            ~promise(void) noexcept {
+                if(m_state)
+                    m_state->release();
+            }
+
+            /**
+             * @brief Gets the future that this promise fulfils.
+             * @note   Must be called once
+             * @retval The future
+             */
+            [[nodiscard]] future<T> get_future(void) noexcept {
+                m_state->add_ref();
+                return future<T>(m_state);
+            }
+
+            /**
+             * @brief Makes the value available to the future.
+             * @note   Must be called once
+             * @param  value: Arguments to construct the value with
+             * @retval None
+             */
+            template<typename... V>
+            void set_value(V&&... value) noexcept {
+                m_state->set_value(std::forward<V>(value)...);
+            }
+        private:
+            shared_state<T>* m_state;
+        };
+
+        /**
+         * @brief Creates a future that is already available.
+         * @note
+         * @param  value: The value
+         * @retval A ready future
+         */
+        template<typename T>
+        [[nodiscard]] inline future<std::decay_t<T>> make_ready_future(T&& value) noexcept {
+            promise<std::decay_t<T>> result;
+            result.set_value(std::forward<T>(value));
+            return result.get_future();
+        }
+
+        /**
+         * @brief Combines futures into one that becomes available when all of them are.
+         * @note   Void results are stored as std::monostate
+         * @param  futures: The futures
+         * @retval A future of all the results, in order
+         */
+        template<typename... Ts>
+        [[nodiscard]] inline future<std::tuple<value_t<Ts>...>> when_all(future<Ts>&&... futures) noexcept {
+            struct all_state {
+                std::tuple<std::optional<value_t<Ts>>...> values;
+                std::atomic<size_t> left = sizeof...(Ts);
+                promise<std::tuple<value_t<Ts>...>> done;
+            };
+
+            const auto finish = [](all_state& all) {
+                [&]<size_t... I>(std::index_sequence<I...>) {
+                    all.done.set_value(std::move(*std::get<I>(all.values))...);
+                }(std::index_sequence_for<Ts...>());
+            };
+
+            std::shared_ptr<all_state> state = std::make_shared<all_state>();
+            future<std::tuple<value_t<Ts>...>> result = state->done.get_future();
+            if constexpr(sizeof...(Ts) == 0)
+                finish(*state);
+            else
+                [&]<size_t... I>(std::index_sequence<I...>) {
+                    (futures.on_ready([state, finish](auto&& value) {
+                        std::get<I>(state->values).emplace(std::move(value));
+                        if(state->left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                            finish(*state);
+                    }), ...);
+                }(std::index_sequence_for<Ts...>());
+            return result;
+        }
+
+        /**
+         * @brief Combines futures into one that becomes available when all of them are.
+         * @note
+         * @param  futures: The futures
+         * @retval A future of all the results, in order. Void futures give a future<void>
+         */
+        template<typename T>
+        [[nodiscard]] inline auto when_all(std::vector<future<T>> futures) noexcept {
+            using result_t = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+            struct all_state {
+                std::vector<std::optional<value_t<T>>> values;
+                std::atomic<size_t> left;
+                promise<result_t> done;
+            };
+
+            std::shared_ptr<all_state> state = std::make_shared<all_state>();
+            state->values.resize(futures.size());
+            state->left.store(futures.size(), std::memory_order_relaxed);
+            future<result_t> result = state->done.get_future();
+
+            const auto finish = [](all_state& all) {
+                if constexpr(std::is_void_v<T>)
+                    all.done.set_value();
+                else {
+                    std::vector<T> values;
+                    values.reserve(all.values.size());
+                    for(std::optional<T>& value : all.values)
+                        values.emplace_back(std::move(*value));
+                    all.done.set_value(std::move(values));
+                }
+            };
+
+            if(futures.empty()) [[unlikely]]
+                finish(*state);
+            for(size_t i = 0; i < futures.size(); ++i)
+                futures[i].on_ready([state, i, finish](value_t<T>&& value) {
+                    state->values[i].emplace(std::move(value));
+                    if(state->left.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        finish(*state);
+                });
+            return result;
+        }
+
+        /**
+         * @brief Combines futures into one that becomes available when the first of them is.
+         * @note   The other results are discarded when they arrive. Must be given at least one future
+         * @param  futures: The futures
+         * @retval A future of the index of the first finished future and its result(only the index for void)
+         */
+        template<typename T>
+        [[nodiscard]] inline auto when_any(std::vector<future<T>> futures) noexcept {
+            using result_t = std::conditional_t<std::is_void_v<T>, size_t, std::pair<size_t, value_t<T>>>;
+            struct any_state {
+                std::atomic<bool> finished = false;
+                promise<result_t> done;
+            };
+
+            std::shared_ptr<any_state> state = std::make_shared<any_state>();
+            future<result_t> result = state->done.get_future();
+            for(size_t i = 0; i < futures.size(); ++i)
+                futures[i].on_ready([state, i](value_t<T>&& value) {
+                    if(state->finished.exchange(true, std::memory_order_acq_rel))
+                        return;
+                    if constexpr(std::is_void_v<T>)
+                        state->done.set_value(i);
+                    else
+                        state->done.set_value(i, std::move(value));
+                });
+            return result;
+        }
+    } // namespace async
+} // namespace xenon
+
+#endif // XENON_HG_ASYNC_FUTURE
@@ -0,0 +1,266 @@
+// parallel.hpp
+//
+// Parallel algorithms that are a part of an Async module.
+
+#ifndef XENON_HG_ASYNC_PARALLEL
+#define XENON_HG_ASYNC_PARALLEL
+
+// Libraries
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Other parts of the Async component
+#include "thread_pool.hpp"
+
+// Xenon's Modules
+#include "../concepts/concepts.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    /**
+     * @brief Picks a grain that gives every worker about 8 chunks, so that chunks that run slower than others balance out.
+     */
+    inline size_t XENON_HF_parallel_grain(const size_t count, const size_t grain, const xenon::async::thread_pool& pool) noexcept {
+        return grain != 0 ? grain : std::max<size_t>(1, count / (static_cast<size_t>(pool.size()) * 8));
+    }
+
+    /**
+     * @brief Splits [0, count) into chunks of grain elements and runs chunk_func(begin, end) on each of them.
+     * @note   The calling thread works on chunks too, so it's safe to call from a pool worker. Chunks are claimed one by one, so uneven chunks balance out.
+     */
+    template<typename F>
+    inline void XENON_HF_parallel_chunks(const size_t count, size_t grain, xenon::async::thread_pool& pool, F&& chunk_func) noexcept {
+        if(count == 0) [[unlikely]]
+            return;
+        grain = XENON_HF_parallel_grain(count, grain, pool);
+        const size_t chunks = (count + grain - 1) / grain;
+        if(chunks == 1 || pool.size() == 1) [[unlikely]] {
+            chunk_func(size_t(0), count);
+            return;
+        }
+
+        struct shared {
+            std::atomic<size_t> next = 0;
+            std::atomic<size_t> left;
+            size_t chunks;
+            size_t grain;
+            size_t count;
+            std::remove_reference_t<F>* chunk_func;
+
+            void work(void) noexcept {
+                size_t done = 0;
+                for(size_t chunk = next.fetch_add(1, std::memory_order_relaxed); chunk < chunks; chunk = next.fetch_add(1, std::memory_order_relaxed)) {
+                    const size_t begin = chunk * grain;
+                    (*chunk_func)(begin, std::min(begin + grain, count));
+                    ++done;
+                }
+                if(done != 0 && left.fetch_sub(done, std::memory_order_acq_rel) == done)
+                    left.notify_all();
+            }
+        };
+
+        // Helpers that start after everything is done only touch the counters, which the shared_ptr keeps alive
+        std::shared_ptr<shared> state = std::make_shared<shared>();
+        state->left.store(chunks, std::memory_order_relaxed);
+        state->chunks = chunks;
+        state->grain = grain;
+        state->count = count;
+        state->chunk_func = &chunk_func;
+
+        const size_t helpers = std::min<size_t>(pool.size(), chunks) - 1;
+        for(size_t i = 0; i < helpers; ++i)
+            pool.submit([state]() { state->work(); });
+        state->work();
+        for(size_t left = state->left.load(std::memory_order_acquire); left != 0; left = state->left.load(std::memory_order_acquire))
+            state->left.wait(left, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Runs range_func(first, last, chunk) over chunks of a container's iterators.
+     * @note   Non random access iterators are walked once up front to find where each chunk starts.
+     */
+    template<typename C, typename F>
+    inline void XENON_HF_parallel_ranges(C& container, size_t grain, xenon::async::thread_pool& pool, F&& range_func) noexcept {
+        using iterator_t = decltype(container.begin());
+        const iterator_t first = container.begin();
+        const size_t count = static_cast<size_t>(std::distance(first, container.end()));
+        grain = XENON_HF_parallel_grain(count, grain, pool);
+        if constexpr(std::random_access_iterator<iterator_t>)
+            XENON_HF_parallel_chunks(count, grain, pool, [&](const size_t begin, const size_t end) {
+                range_func(first + begin, first + end, begin / grain);
+            });
+        else {
+            std::vector<iterator_t> starts;
+            starts.reserve(count / grain + 2);
+            iterator_t it = first;
+            for(size_t i = 0; i < count; i += grain) {
+                starts.push_back(it);
+                std::advance(it, std::min(grain, count - i));
+            }
+            starts.push_back(it);
+            XENON_HF_parallel_chunks(count, grain, pool, [&](const size_t begin, const size_t end) {
+                const size_t chunk = begin / grain;
+                range_func(starts[chunk], end == count ? starts.back() : starts[chunk + 1], chunk);
+            });
+        }
+    }
+}
+
+namespace xenon {
+    namespace async {
+        /**
+         * @brief Calls a function with every index in [begin, end) in parallel.
+         * @note
+         * @param  begin: First index
+         * @param  end: One past the last index
+         * @param  func: The function that accepts an index
+         * @param  grain: How many indices one job processes. 0 picks it from the amount of work and workers
+         * @param  pool: The pool to run on
+         * @retval None
+         */
+        template<typename F>
+            requires xenon::concepts::callable<F, size_t>
+        inline void parallel_for(const size_t begin, const size_t end, F&& func, const size_t grain = 0, thread_pool& pool = xenon::async::default_pool()) noexcept {
+            XENON_HF_parallel_chunks(end > begin ? end - begin : 0, grain, pool, [&](const size_t first, const size_t last) {
+                for(size_t i = begin + first; i < begin + last; ++i)
+                    func(i);
+            });
+        }
+
+        /**
+         * @brief Calls a function with every element of a container in parallel.
+         * @note
+         * @param  container: The container
+         * @param  func: The function that accepts an element
+         * @param  grain: How many elements one job processes. 0 picks it from the amount of work and workers
+         * @param  pool: The pool to run on
+         * @retval None
+         */
+        template<typename C, typename F>
+            requires xenon::concepts::has_iterator<C> && xenon::concepts::callable<F, decltype(*std::declval<C&>().begin())>
+        inline void parallel_for(C& container, F&& func, const size_t grain = 0, thread_pool& pool = xenon::async::default_pool()) noexcept {
+            XENON_HF_parallel_ranges(container, grain, pool, [&](auto first, const auto last, const size_t) {
+                for(; first != last; ++first)
+                    func(*first);
+            });
+        }
+
+        /**
+         * @brief Folds every element of a container in parallel.
+         * @note   Each chunk starts from identity and the partial results are folded in order, so reduce_func has to be associative.
+         * @param  container: The container
+         * @param  identity: The starting value of each chunk, e.g. 0 for a sum
+         * @param  reduce_func: The function that accepts an accumulated value and an element(or another accumulated value) and returns a new one
+         * @param  grain: How many elements one job processes. 0 picks it from the amount of work and workers
+         * @param  pool: The pool to run on
+         * @retval The folded value
+         */
+        template<typename C, typename T, typename F>
+            requires xenon::concepts::has_iterator<C> && xenon::concepts::callable<F, T, decltype(*std::declval<C&>().begin())> && xenon::concepts::callable<F, T, T>
+        [[nodiscard]] inline T parallel_reduce(C& container, const T identity, F&& reduce_func, const size_t grain = 0, thread_pool& pool = xenon::async::default_pool()) noexcept {
+            const size_t count = static_cast<size_t>(std::distance(container.begin(), container.end()));
+            const size_t chunk_grain = XENON_HF_parallel_grain(count, grain, pool);
+            std::vector<std::optional<T>> partials((count + chunk_grain - 1) / chunk_grain);
+            XENON_HF_parallel_ranges(container, chunk_grain, pool, [&](auto first, const auto last, const size_t chunk) {
+                T value = identity;
+                for(; first != last; ++first)
+                    value = reduce_func(std::move(value), *first);
+                partials[chunk].emplace(std::move(value));
+            });
+            T result = identity;
+            for(std::optional<T>& partial : partials)
+                if(partial)
+                    result = reduce_func(std::move(result), std::move(*partial));
+            return result;
+        }
+
+        /**
+         * @brief Writes the result of a function on every element of a container into another container, in parallel.
+         * @note   out has to have at least as many elements as in. Bit-packed containers like std::vector<bool> are rejected, because neighbouring elements share bytes and chunks would race on them
+         * @param  in: The input container
+         * @param  out: The output container
+         * @param  func: The function that accepts an input element and returns an output one
+         * @param  grain: How many elements one job processes. 0 picks it from the amount of work and workers
+         * @param  pool: The pool to run on
+         * @retval None
+         */
+        template<typename C, typename C_, typename F>
+            requires xenon::concepts::has_iterator<C> && xenon::concepts::has_iterator<C_> && xenon::concepts::callable<F, decltype(*std::declval<C&>().begin())>
+        inline void parallel_transform(C& in, C_& out, F&& func, const size_t grain = 0, thread_pool& pool = xenon::async::default_pool()) noexcept {
+            using out_iterator_t = decltype(out.begin());
+            static_assert(std::is_reference_v<decltype(*out.begin())>, "parallel_transform can't write into a container whose elements are proxies, e.g. std::vector<bool>");
+            if constexpr(std::random_access_iterator<out_iterator_t>) {
+                const out_iterator_t out_first = out.begin();
+                const size_t chunk_grain = XENON_HF_parallel_grain(static_cast<size_t>(std::distance(in.begin(), in.end())), grain, pool);
+                XENON_HF_parallel_ranges(in, chunk_grain, pool, [&](auto first, const auto last, const size_t chunk) {
+                    for(out_iterator_t it = out_first + chunk * chunk_grain; first != last; ++first, ++it)
+                        *it = func(*first);
+                });
+            } else {
+                std::vector<out_iterator_t> targets;
+                for(out_iterator_t it = out.begin(); it != out.end(); ++it)
+                    targets.push_back(it);
+                const size_t chunk_grain = XENON_HF_parallel_grain(targets.size(), grain, pool);
+                XENON_HF_parallel_ranges(in, chunk_grain, pool, [&](auto first, const auto last, const size_t chunk) {
+                    for(size_t i = chunk * chunk_grain; first != last; ++first, ++i)
+                        *targets[i] = func(*first);
+                });
+            }
+        }
+
+        /**
+         * @brief Collects the result of a function on every element of a container, in parallel.
+         * @note
+         * @param  in: The input container
+         * @param  func: The function that accepts an input element and returns an output one
+         * @param  grain: How many elements one job processes. 0 picks it from the amount of work and workers
+         * @param  pool: The pool to run on
+         * @retval A vector of results in the same order
+         */
+        template<typename C, typename F>
+            requires xenon::concepts::has_iterator<C> && xenon::concepts::callable<F, decltype(*std::declval<C&>().begin())>
+        [[nodiscard]] inline auto parallel_transform(C& in, F&& func, const size_t grain = 0, thread_pool& pool = xenon::async::default_pool()) noexcept {
+            using result_t = std::decay_t<decltype(func(*in.begin()))>;
+            const size_t count = static_cast<size_t>(std::distance(in.begin(), in.end()));
+            const size_t chunk_grain = XENON_HF_parallel_grain(count, grain, pool);
+            if constexpr(std::is_same_v<result_t, bool>) {
+                // std::vector<bool> packs elements into shared bytes, so every result gets a byte of its own first
+                std::vector<char> bytes(count);
+                XENON_HF_parallel_ranges(in, chunk_grain, pool, [&](auto first, const auto last, const size_t chunk) {
+                    for(size_t i = chunk * chunk_grain; first != last; ++first, ++i)
+                        bytes[i] = static_cast<char>(func(*first));
+                });
+                return std::vector<bool>(bytes.begin(), bytes.end());
+            } else if constexpr(std::is_default_constructible_v<result_t>) {
+                std::vector<result_t> results(count);
+                XENON_HF_parallel_ranges(in, chunk_grain, pool, [&](auto first, const auto last, const size_t chunk) {
+                    for(size_t i = chunk * chunk_grain; first != last; ++first, ++i)
+                        results[i] = func(*first);
+                });
+                return results;
+            } else {
+                std::vector<std::optional<result_t>> slots(count);
+                XENON_HF_parallel_ranges(in, chunk_grain, pool, [&](auto first, const auto last, const size_t chunk) {
+                    for(size_t i = chunk * chunk_grain; first != last; ++first, ++i)
+                        slots[i].emplace(func(*first));
+                });
+                std::vector<result_t> results;
+                results.reserve(count);
+                for(std::optional<result_t>& slot : slots)
+                    results.emplace_back(std::move(*slot));
+                return results;
+            }
+        }
+    } // namespace async
+} // namespace xenon
+
+#endif // XENON_HG_ASYNC_PARALLEL
@@ -0,0 +1,379 @@
+// task.hpp
+//
+// A coroutine task class that is a part of an Async module.
+//
+// Define XENON_M_ASYNC_POOLED_FRAMES before including Xenon to allocate coroutine frames from per-thread free lists instead of the global heap.
+
+#ifndef XENON_HG_ASYNC_TASK
+#define XENON_HG_ASYNC_TASK
+
+// Libraries
+#include <coroutine>
+#include <cassert>
+#include <exception>
+#include <optional>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Other parts of the Async component
+#include "thread_pool.hpp"
+#include "future.hpp"
+
+namespace xenon {
+    namespace async {
+        /**
+         * @brief An allocator for coroutine frames with power of two size classes and a free list per thread.
+         * @note   Frames bigger than the biggest size class go straight to the global heap.
+         */
+        class frame_pool final {
+        public:
+            /**
+             * @brief The smallest size class in bytes.
+             * @note
+             */
+            static constexpr size_t min_size = 64;
+
+            /**
+             * @brief The amount of size classes. The biggest one is min_size << (classes - 1).
+             * @note
+             */
+            static constexpr size_t classes = 7;
+
+            /**
+             * @brief How many released frames of each size class each thread keeps around for reuse.
+             * @note
+             */
+            static constexpr size_t cache_capacity = 1024;
+
+            /**
+             * @brief Allocates a frame.
+             * @note
+             * @param  size: Size of the frame
+             * @retval Pointer to the frame
+             */
+            [[nodiscard]] static void* allocate(const size_t size) noexcept {
+                const size_t index = size_class(size);
+                if(index == classes) [[unlikely]]
+                    return ::operator new(size);
+                std::vector<void*>& frames = free_list().frames[index];
+                if(!frames.empty()) [[likely]] {
+                    void* frame = frames.back();
+                    frames.pop_back();
+                    return frame;
+                }
+                return ::operator new(min_size << index);
+            }
+
+            /**
+             * @brief Gives a frame back to the calling thread's free list.
+             * @note
+             * @param  frame: Pointer to the frame
+             * @param  size: The size that was passed to allocate()
+             * @retval None
+             */
+            static void deallocate(void* frame, const size_t size) noexcept {
+                const size_t index = size_class(size);
+                if(index != classes) [[likely]] {
+                    std::vector<void*>& frames = free_list().frames[index];
+                    if(frames.size() < cache_capacity) [[likely]] {
+                        frames.push_back(frame);
+                        return;
+                    }
+                }
+                ::operator delete(frame);
+            }
+        private:
+            struct cache {
+                std::vector<void*> frames[classes];
+
+                ~cache(void) noexcept {
+                    for(std::vector<void*>& size_class : frames)
+                        for(void* frame : size_class)
+                            ::operator delete(frame);
+                }
+            };
+
+            static cache& free_list(void) noexcept {
+                static thread_local cache frames;
+                return frames;
+            }
+
+            static size_t size_class(const size_t size) noexcept {
+                size_t index = 0;
+                while(index < classes && (min_size << index) < size)
+                    ++index;
+                return index;
+            }
+        };
+
+        /**
+         * @brief A base for coroutine promises that picks where the frames come from.
+         * @note   Uses the frame_pool when XENON_M_ASYNC_POOLED_FRAMES is defined.
+         */
+        struct frame_allocation {
+#ifdef XENON_M_ASYNC_POOLED_FRAMES
+            static void* operator new(const size_t size) {
+                return xenon::async::frame_pool::allocate(size);
+            }
+
+            static void operator delete(void* frame, const size_t size) noexcept {
+                xenon::async::frame_pool::deallocate(frame, size);
+            }
+#endif // XENON_M_ASYNC_POOLED_FRAMES
+        };
+
+        template<typename T>
+        class task;
+
+        /**
+         * @brief The part of a task's promise that stores the result.
+         * @note
+         */
+        template<typename T>
+        struct task_result {
+            std::optional<T> m_value;
+
+            template<typename V>
+                requires std::is_convertible_v<V&&, T>
+            void return_value(V&& value) noexcept {
+                m_value.emplace(std::forward<V>(value));
+            }
+
+            T take(void) noexcept {
+                return std::move(*m_value);
+            }
+        };
+
+        template<>
+        struct task_result<void> {
+            void return_void(void) noexcept {}
+
+            void take(void) noexcept {}
+        };
+
+        /**
+         * @brief A lazily started coroutine that produces a T. Move-only.
+         * @note   A task starts when it is co_awaited, or when it is given to spawn(). Awaiting a task continues on the thread that finishes it.
+         */
+        template<typename T = void>
+        class [[nodiscard]] task final {
+        public:
+            struct promise_type : xenon::async::frame_allocation, xenon::async::task_result<T> {
+                std::coroutine_handle<> m_continuation;
+
+                task get_return_object(void) noexcept {
+                    return task(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+
+                std::suspend_always initial_suspend(void) noexcept {
+                    return {};
+                }
+
+                auto final_suspend(void) noexcept {
+                    struct final_awaiter {
+                        bool await_ready(void) noexcept {
+                            return false;
+                        }
+
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                            const std::coroutine_handle<> continuation = handle.promise().m_continuation;
+                            return continuation ? continuation : std::noop_coroutine();
+                        }
+
+                        void await_resume(void) noexcept {}
+                    };
+                    return final_awaiter{};
+                }
+
+                void unhandled_exception(void) noexcept {
+                    std::terminate();
+                }
+            };
+
+            task(void) noexcept = default;
+
+            task(task&& other) noexcept
+                : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+            task& operator=(task&& other) noexcept {
+                if(this != &other) [[likely]] {
+                    if(m_handle)
+                        m_handle.destroy();
+                    m_handle = std::exchange(other.m_handle, nullptr);
+                }
+                return *this;
+            }
+
+            task(const task&) = delete;
+            task& operator=(const task&) = delete;
+
+            ~task(void) noexcept {
+                if(m_handle)
+                    m_handle.destroy();
+            }
+
+            /**
+             * @brief Checks whether the task refers to a coroutine.
+             * @note
+             * @retval True if it does
+             */
+            [[nodiscard]] bool valid(void) const noexcept {
+                return static_cast<bool>(m_handle);
+            }
+
+            /**
+             * @brief Starts the task and suspends the awaiting coroutine until it finishes.
+             * @note   The task has to be valid(), an empty or moved-from task has no result to give.
+             * @retval An awaiter that gives the result
+             */
+            auto operator co_await(void) && noexcept {
+                struct awaiter {
+                    std::coroutine_handle<promise_type> m_handle;
+
+                    bool await_ready(void) noexcept {
+                        assert(m_handle && "co_await on an empty task");
+                        return m_handle.done();
+                    }
+
+                    std::coroutine_handle<> await_suspend(const std::coroutine_handle<> continuation) noexcept {
+                        m_handle.promise().m_continuation = continuation;
+                        return m_handle;
+                    }
+
+                    T await_resume(void) noexcept {
+                        return m_handle.promise().take();
+                    }
+                };
+                return awaiter{ m_handle };
+            }
+        private:
+            explicit task(const std::coroutine_handle<promise_type> handle) noexcept
+                : m_handle(handle) {}
+
+            std::coroutine_handle<promise_type> m_handle;
+        };
+
+        /**
+         * @brief A fire-and-forget coroutine that frees itself when it finishes. Used internally by spawn().
+         * @note
+         */
+        struct detached_task {
+            struct promise_type : xenon::async::frame_allocation {
+                detached_task get_return_object(void) noexcept {
+                    return { std::coroutine_handle<promise_type>::from_promise(*this) };
+                }
+
+                std::suspend_always initial_suspend(void) noexcept {
+                    return {};
+                }
+
+                std::suspend_never final_suspend(void) noexcept {
+                    return {};
+                }
+
+                void return_void(void) noexcept {}
+
+                void unhandled_exception(void) noexcept {
+                    std::terminate();
+                }
+            };
+
+            std::coroutine_handle<promise_type> m_handle;
+        };
+    } // namespace async
+} // namespace xenon
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    template<typename T>
+    xenon::async::detached_task XENON_HF_spawn_root(xenon::async::task<T> work, xenon::async::shared_state<T>* state) {
+        if constexpr(std::is_void_v<T>) {
+            co_await std::move(work);
+            state->set_value();
+        } else
+            state->set_value(co_await std::move(work));
+        state->release();
+    }
+}
+
+namespace xenon {
+    namespace async {
+        /**
+         * @brief Starts a task on a thread pool.
+         * @note
+         * @param  work: The task
+         * @param  pool: The pool that the task starts on
+         * @retval A future of the task's result
+         */
+        template<typename T>
+        inline future<T> spawn(task<T> work, thread_pool& pool = xenon::async::default_pool()) noexcept {
+            shared_state<T>* state = shared_state<T>::acquire();
+            state->add_ref();
+            const std::coroutine_handle<> root = XENON_HF_spawn_root(std::move(work), state).m_handle;
+            pool.submit([root]() { root.resume(); });
+            return future<T>(state);
+        }
+
+        /**
+         * @brief Moves the awaiting coroutine onto a thread pool.
+         * @note   Use as co_await xenon::async::schedule();
+         * @param  pool: The pool to continue on
+         * @retval An awaiter
+         */
+        [[nodiscard]] inline auto schedule(thread_pool& pool = xenon::async::default_pool()) noexcept {
+            struct awaiter {
+                thread_pool& m_pool;
+
+                bool await_ready(void) noexcept {
+                    return false;
+                }
+
+                void await_suspend(const std::coroutine_handle<> handle) noexcept {
+                    m_pool.submit([handle]() { handle.resume(); });
+                }
+
+                void await_resume(void) noexcept {}
+            };
+            return awaiter{ pool };
+        }
+
+        /**
+         * @brief Suspends the awaiting coroutine until the future is ready and resumes it on the default pool.
+         * @note   This is how blocking work is awaited, e.g. co_await xenon::async::run(xenon::files::read_file, path);
+         * @param  result: The future
+         * @retval An awaiter that gives the result
+         */
+        template<typename T>
+        [[nodiscard]] inline auto operator co_await(future<T>&& result) noexcept {
+            struct awaiter {
+                future<T> m_future;
+                std::optional<value_t<T>> m_value;
+
+                bool await_ready(void) noexcept {
+                    return m_future.is_ready();
+                }
+
+                void await_suspend(const std::coroutine_handle<> handle) noexcept {
+                    m_future.on_ready([this, handle](value_t<T>&& value) {
+                        m_value.emplace(std::move(value));
+                        xenon::async::default_pool().submit([handle]() { handle.resume(); });
+                    });
+                }
+
+                T await_resume(void) noexcept {
+                    if(!m_value) [[likely]]
+                        return m_future.get();
+                    if constexpr(!std::is_void_v<T>)
+                        return std::move(*m_value);
+                }
+            };
+            return awaiter{ std::move(result), std::nullopt };
+        }
+    } // namespace async
+} // namespace xenon
+
+#endif // XENON_HG_ASYNC_TASK
@@ -0,0 +1,402 @@
+// thread_pool.hpp
+//
+// A work-stealing thread pool that is a part of an Async module.
+
+#ifndef XENON_HG_ASYNC_THREAD_POOL
+#define XENON_HG_ASYNC_THREAD_POOL
+
+// Libraries
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Xenon's Modules
+#include "../concepts/concepts.hpp"
+#include "../bench/profiler.hpp"
+
+namespace xenon {
+    namespace async {
+        /**
+         * @brief A move-only type-erased void() callable. Small callables are stored inline, so most jobs don't allocate.
+         * @note
+         */
+        class job final {
+        public:
+            /**
+             * @brief Size of the inline storage in bytes. Callables that are bigger get allocated on the heap.
+             * @note
+             */
+            static constexpr size_t inline_size = 48;
+
+            job(void) noexcept = default;
+
+            /**
+             * @brief Constructs the job from any callable that accepts no arguments.
+             * @note
+             * @param  func: The callable
+             */
+            template<typename F>
+                requires (!std::is_same_v<std::decay_t<F>, job>) && xenon::concepts::callable<std::decay_t<F>&>
+            job(F&& func) noexcept {
+                using func_t = std::decay_t<F>;
+                if constexpr(sizeof(func_t) <= inline_size && alignof(func_t) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<func_t>) {
+                    ::new(static_cast<void*>(m_storage)) func_t(std::forward<F>(func));
+                    m_vtable = &vtable_for<func_t, true>;
+                } else {
+                    *reinterpret_cast<func_t**>(m_storage) = new func_t(std::forward<F>(func));
+                    m_vtable = &vtable_for<func_t, false>;
+                }
+            }
+
+            job(job&& other) noexcept {
+                move_from(other);
+            }
+
+            job& operator=(job&& other) noexcept {
+                if(this != &other) [[likely]] {
+                    reset();
+                    move_from(other);
+                }
+                return *this;
+            }
+
+            job(const job&) = delete;
+            job& operator=(const job&) = delete;
+
+            ~job(void) noexcept {
+                reset();
+            }
+
+            /**
+             * @brief Calls the stored callable.
+             * @note   The job must not be empty
+             * @retval None
+             */
+            void operator()(void) {
+                m_vtable->invoke(m_storage);
+            }
+
+            /**
+             * @brief Checks whether the job holds a callable.
+             * @note
+             * @retval True if it does
+             */
+            [[nodiscard]] explicit operator bool(void) const noexcept {
+                return m_vtable != nullptr;
+            }
+        private:
+            struct vtable {
+                void (*invoke)(void*);
+                void (*move)(void*, void*) noexcept;
+                void (*destroy)(void*) noexcept;
+            };
+
+            template<typename F, bool Inline>
+            static constexpr vtable vtable_for = {
+                [](void* storage) {
+                    if constexpr(Inline)
+                        (*static_cast<F*>(storage))();
+                    else
+                        (**static_cast<F**>(storage))();
+                },
+                [](void* from, void* to) noexcept {
+                    if constexpr(Inline) {
+                        ::new(to) F(std::move(*static_cast<F*>(from)));
+                        static_cast<F*>(from)->~F();
+                    } else
+                        *static_cast<F**>(to) = *static_cast<F**>(from);
+                },
+                [](void* storage) noexcept {
+                    if constexpr(Inline)
+                        static_cast<F*>(storage)->~F();
+                    else
+                        delete *static_cast<F**>(storage);
+                }
+            };
+
+            void move_from(job& other) noexcept {
+                if(other.m_vtable) [[likely]] {
+                    other.m_vtable->move(other.m_storage, m_storage);
+                    m_vtable = std::exchange(other.m_vtable, nullptr);
+                }
+            }
+
+            void reset(void) noexcept {
+                if(m_vtable) {
+                    m_vtable->destroy(m_storage);
+                    m_vtable = nullptr;
+                }
+            }
+
+            alignas(std::max_align_t) std::byte m_storage[inline_size];
+            const vtable* m_vtable = nullptr;
+        };
+
+        /**
+         * @brief A thread pool with a deque per worker. Workers pop their own deque from the front and steal from the back of the others when they run dry.
+         * @note   Submitting from a worker pushes to that worker's own deque, submitting from any other thread spreads jobs round-robin.
+         */
+        class thread_pool final {
+        public:
+            /**
+             * @brief Constructs the pool and starts the workers.
+             * @note
+             * @param  threads: Amount of worker threads. 0 means std::thread::hardware_concurrency()
+             * @param  max_pending: Maximum amount of queued jobs before submit() starts blocking the caller. 0 means unbounded
+             */
+            explicit thread_pool(uint32_t threads = 0, const uint64_t max_pending = 0) noexcept
+                : m_max_pending(max_pending) {
+                if(threads == 0) [[likely]]
+                    threads = std::max(1u, std::thread::hardware_concurrency());
+                m_queues = std::make_unique<worker_queue[]>(threads);
+                m_queue_count = threads;
+                m_workers.reserve(threads);
+                for(uint32_t i = 0; i < threads; ++i)
+                    m_workers.emplace_back([this, i]() { worker_loop(i); });
+            }
+
+            /**
+             * @brief Runs every job that is still queued, then stops and joins the workers.
+             * @note
+             */
+            ~thread_pool(void) noexcept {
+                {
+                    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                    m_stopping = true;
+                }
+                m_sleep_cv.notify_all();
+                for(std::thread& worker : m_workers)
+                    worker.join();
+            }
+
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator=(const thread_pool&) = delete;
+
+            /**
+             * @brief Queues a function with specified arguments. Blocks while the pool is at max_pending.
+             * @note   A worker of this pool doesn't block, it runs the function inline instead. Otherwise workers waiting for space could take up the whole pool and nothing would ever free it.
+             * @param  func: The function itself
+             * @param  args: All the args that the function accepts
+             * @retval None
+             */
+            template<typename F, typename... Args>
+                requires xenon::concepts::callable<F, Args...>
+            void submit(F&& func, Args&&... args) noexcept {
+                if(m_max_pending != 0) [[unlikely]] {
+                    if(is_worker()) {
+                        if(m_pending.load(std::memory_order_acquire) >= m_max_pending) {
+                            make_job(std::forward<F>(func), std::forward<Args>(args)...)();
+                            return;
+                        }
+                    } else {
+                        std::unique_lock<std::mutex> lock(m_space_mutex);
+                        m_space_cv.wait(lock, [this]() { return m_pending.load(std::memory_order_acquire) < m_max_pending; });
+                    }
+                }
+                push(make_job(std::forward<F>(func), std::forward<Args>(args)...));
+            }
+
+            /**
+             * @brief Queues a function with specified arguments unless the pool is at max_pending.
+             * @note
+             * @param  func: The function itself
+             * @param  args: All the args that the function accepts
+             * @retval True if the function was queued
+             */
+            template<typename F, typename... Args>
+                requires xenon::concepts::callable<F, Args...>
+            bool try_submit(F&& func, Args&&... args) noexcept {
+                if(m_max_pending != 0 && m_pending.load(std::memory_order_acquire) >= m_max_pending) [[unlikely]]
+                    return false;
+                push(make_job(std::forward<F>(func), std::forward<Args>(args)...));
+                return true;
+            }
+
+            /**
+             * @brief Blocks until every queued and running job has finished.
+             * @note   Must not be called from a worker of this pool
+             * @retval None
+             */
+            void wait_idle(void) noexcept {
+                std::unique_lock<std::mutex> lock(m_space_mutex);
+                m_idle_cv.wait(lock, [this]() { return m_unfinished.load(std::memory_order_acquire) == 0; });
+            }
+
+            /**
+             * @brief Gets the amount of worker threads.
+             * @note
+             * @retval Amount of workers
+             */
+            [[nodiscard]] uint32_t size(void) const noexcept {
+                return m_queue_count;
+            }
+
+            /**
+             * @brief Gets the amount of jobs that are queued but not yet started.
+             * @note
+             * @retval Amount of pending jobs
+             */
+            [[nodiscard]] uint64_t pending(void) const noexcept {
+                return m_pending.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Checks whether the calling thread is one of this pool's workers.
+             * @note
+             * @retval True if it is
+             */
+            [[nodiscard]] bool is_worker(void) const noexcept {
+                return current_worker().pool == this;
+            }
+        private:
+            struct alignas(64) worker_queue {
+                std::mutex mutex;
+                std::deque<job> jobs;
+            };
+
+            struct worker_info {
+                const thread_pool* pool = nullptr;
+                uint32_t index = 0;
+            };
+
+            static worker_info& current_worker(void) noexcept {
+                static thread_local worker_info info;
+                return info;
+            }
+
+            template<typename F, typename... Args>
+            static job make_job(F&& func, Args&&... args) noexcept {
+                if constexpr(sizeof...(Args) == 0)
+                    return job(std::forward<F>(func));
+                else
+                    return job([func = std::forward<F>(func), ... args = std::forward<Args>(args)]() mutable {
+                        func(std::move(args)...);
+                    });
+            }
+
+            void push(job&& work) noexcept {
+                const worker_info& self = current_worker();
+                const uint32_t index = self.pool == this ? self.index : static_cast<uint32_t>(m_next.fetch_add(1, std::memory_order_relaxed) % m_queue_count);
+                // Counted before the job becomes visible so that a worker can never take the counter below zero
+                m_unfinished.fetch_add(1, std::memory_order_relaxed);
+                m_pending.fetch_add(1);
+                {
+                    std::lock_guard<std::mutex> lock(m_queues[index].mutex);
+                    m_queues[index].jobs.emplace_back(std::move(work));
+                }
+                if(m_sleeping.load() > 0) [[unlikely]] {
+                    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+                    m_sleep_cv.notify_one();
+                }
+            }
+
+            bool try_pop(const uint32_t index, job& out) noexcept {
+                // Own deque first, from the front
+                {
+                    std::lock_guard<std::mutex> lock(m_queues[index].mutex);
+                    if(!m_queues[index].jobs.empty()) [[likely]] {
+                        out = std::move(m_queues[index].jobs.front());
+                        m_queues[index].jobs.pop_front();
+                        return true;
+                    }
+                }
+                // Then steal from the back of the others. Busy deques are skipped at first and waited for on a second pass,
+                // so a worker never goes to sleep while a job it couldn't reach is still pending
+                bool missed = false;
+                for(uint32_t i = 1; i < m_queue_count; ++i) {
+                    worker_queue& victim = m_queues[(index + i) % m_queue_count];
+                    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+                    if(!lock.owns_lock()) {
+                        missed = true;
+                        continue;
+                    }
+                    if(!victim.jobs.empty()) {
+                        out = std::move(victim.jobs.back());
+                        victim.jobs.pop_back();
+                        return true;
+                    }
+                }
+                for(uint32_t i = 1; missed && i < m_queue_count; ++i) {
+                    worker_queue& victim = m_queues[(index + i) % m_queue_count];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if(!victim.jobs.empty()) {
+                        out = std::move(victim.jobs.back());
+                        victim.jobs.pop_back();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void worker_loop(const uint32_t index) noexcept {
+                current_worker() = { this, index };
+                for(job work;;) {
+                    if(try_pop(index, work)) [[likely]] {
+                        m_pending.fetch_sub(1, std::memory_order_acq_rel);
+                        if(m_max_pending != 0) [[unlikely]] {
+                            std::lock_guard<std::mutex> lock(m_space_mutex);
+                            m_space_cv.notify_one();
+                        }
+                        {
+                            XENON_PROFILE_ZONE("xenon::async::job");
+                            work();
+                            work = job();
+                        }
+                        if(m_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) [[unlikely]] {
+                            std::lock_guard<std::mutex> lock(m_space_mutex);
+                            m_idle_cv.notify_all();
+                        }
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+                    m_sleeping.fetch_add(1);
+                    m_sleep_cv.wait(lock, [this]() { return m_stopping || m_pending.load() > 0; });
+                    m_sleeping.fetch_sub(1);
+                    if(m_stopping && m_pending.load(std::memory_order_acquire) == 0) [[unlikely]]
+                        return;
+                }
+            }
+
+            std::unique_ptr<worker_queue[]> m_queues;
+            uint32_t m_queue_count = 0;
+            std::vector<std::thread> m_workers;
+
+            std::atomic<uint64_t> m_next = 0;
+            std::atomic<uint64_t> m_pending = 0;
+            std::atomic<uint64_t> m_unfinished = 0;
+            std::atomic<uint32_t> m_sleeping = 0;
+            const uint64_t m_max_pending;
+
+            std::mutex m_sleep_mutex;
+            std::condition_variable m_sleep_cv;
+            bool m_stopping = false;
+
+            std::mutex m_space_mutex;
+            std::condition_variable m_space_cv;
+            std::condition_variable m_idle_cv;
+        };
+
+        /**
+         * @brief Gets the global pool that run() and then() submit to. Sized to hardware concurrency.
+         * @note   The pool is never destroyed so that jobs still running at exit behave like the detached threads they replace.
+         * @retval The default pool
+         */
+        [[nodiscard]] inline thread_pool& default_pool(void) noexcept {
+            static thread_pool* pool = new thread_pool();
+            return *pool;
+        }
+    } // namespace async
+} // namespace xenon
+
+#endif // XENON_HG_ASYNC_THREAD_POOL
@@ -0,0 +1,351 @@
+// bench.hpp
+//
+// Xenon's Module that is able to measure how fast code runs.
+
+#ifndef XENON_HG_BENCH_MODULE
+#define XENON_HG_BENCH_MODULE
+
+// Libraries
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+
+// Other parts of the Bench component
+#include "profiler.hpp"
+
+// Xenon's Modules
+#include "../concepts/concepts.hpp"
+#include "../time/fast_clock.hpp"
+#include "../files/files.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    inline void XENON_HF_bench_json_string(std::ostream& os, const std::string_view str) noexcept {
+        os << '"';
+        for(const char c : str) {
+            if(c == '"' || c == '\\')
+                os << '\\' << c;
+            else if(static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                os << escaped;
+            } else
+                os << c;
+        }
+        os << '"';
+    }
+
+    inline void XENON_HF_bench_csv_string(std::ostream& os, const std::string_view str) noexcept {
+        os << '"';
+        for(const char c : str)
+            c == '"' ? os << "\"\"" : os << c;
+        os << '"';
+    }
+}
+
+namespace xenon {
+    namespace bench {
+        /**
+         * @brief Makes the compiler assume that the value is used, so the code that computes it isn't optimized away.
+         * @note
+         * @param  value: The value
+         * @retval None
+         */
+        template<typename T>
+        inline void do_not_optimize(const T& value) noexcept {
+#ifdef _MSC_VER
+            static volatile char sink;
+            sink = *reinterpret_cast<const volatile char*>(&value);
+            _ReadWriteBarrier();
+#else
+            asm volatile("" : : "r,m"(value) : "memory");
+#endif // _MSC_VER
+        }
+
+        /**
+         * @brief Makes the compiler assume that all memory was read and written, so stores before it aren't optimized away.
+         * @note
+         * @retval None
+         */
+        inline void clobber_memory(void) noexcept {
+#ifdef _MSC_VER
+            _ReadWriteBarrier();
+#else
+            asm volatile("" : : : "memory");
+#endif // _MSC_VER
+        }
+
+        /**
+         * @brief Settings of a benchmark run.
+         * @note
+         */
+        struct options {
+            // How long to run the function before measuring, in seconds
+            double warmup_time = 0.05;
+            // How long one sample should take at least, in seconds. The amount of calls per sample is picked to reach it
+            double sample_time = 0.005;
+            // Amount of samples
+            uint32_t samples = 31;
+            // How many items one call processes, for the throughput
+            uint64_t items_per_call = 1;
+            // How many bytes one call processes, for the throughput. 0 to not report it
+            uint64_t bytes_per_call = 0;
+        };
+
+        /**
+         * @brief Statistics of a benchmark. Times are per call, in nanoseconds.
+         * @note
+         */
+        struct result {
+            std::string name;
+            // Calls per sample
+            uint64_t iterations = 0;
+            uint32_t samples = 0;
+            double median = 0;
+            double p99 = 0;
+            // Median absolute deviation from the median
+            double mad = 0;
+            double mean = 0;
+            double min = 0;
+            double max = 0;
+            double items_per_second = 0;
+            double bytes_per_second = 0;
+            // Anything else that a benchmark wants to report
+            std::vector<std::pair<std::string, double>> counters;
+        };
+
+        /**
+         * @brief Computes the statistics of a benchmark from its samples.
+         * @note
+         * @param  name: The name of the benchmark
+         * @param  samples: Time of a call in each sample, in nanoseconds
+         * @param  iterations: Calls per sample
+         * @param  items_per_call: How many items one call processes
+         * @param  bytes_per_call: How many bytes one call processes
+         * @retval The statistics
+         */
+        [[nodiscard]] inline result summarize(std::string name, std::vector<double> samples, const uint64_t iterations = 1, const uint64_t items_per_call = 1, const uint64_t bytes_per_call = 0) noexcept {
+            result stats;
+            stats.name = std::move(name);
+            stats.iterations = iterations;
+            stats.samples = static_cast<uint32_t>(samples.size());
+            if(samples.empty()) [[unlikely]]
+                return stats;
+
+            std::sort(samples.begin(), samples.end());
+            const auto percentile = [](const std::vector<double>& sorted, const double p) {
+                const double rank = p * static_cast<double>(sorted.size() - 1);
+                const size_t low = static_cast<size_t>(rank);
+                const size_t high = std::min(low + 1, sorted.size() - 1);
+                return sorted[low] + (sorted[high] - sorted[low]) * (rank - static_cast<double>(low));
+            };
+            stats.median = percentile(samples, 0.5);
+            stats.p99 = percentile(samples, 0.99);
+            stats.min = samples.front();
+            stats.max = samples.back();
+            double sum = 0;
+            for(const double sample : samples)
+                sum += sample;
+            stats.mean = sum / static_cast<double>(samples.size());
+
+            std::vector<double> deviations;
+            deviations.reserve(samples.size());
+            for(const double sample : samples)
+                deviations.push_back(std::abs(sample - stats.median));
+            std::sort(deviations.begin(), deviations.end());
+            stats.mad = percentile(deviations, 0.5);
+
+            if(stats.median > 0) [[likely]] {
+                stats.items_per_second = static_cast<double>(items_per_call) * 1e9 / stats.median;
+                stats.bytes_per_second = static_cast<double>(bytes_per_call) * 1e9 / stats.median;
+            }
+            return stats;
+        }
+
+        /**
+         * @brief Measures a function. Warms it up, picks how many calls fit in a sample and then times the samples.
+         * @note   Pass the function's results to do_not_optimize so that they're not optimized away.
+         * @param  name: The name of the benchmark
+         * @param  func: The function
+         * @param  settings: The settings
+         * @retval The statistics
+         */
+        template<typename F>
+            requires xenon::concepts::callable<F>
+        [[nodiscard]] inline result run(std::string name, F&& func, const options& settings = {}) noexcept {
+            // Warmup doubles as calibration: grow the batch until it takes a sample's worth of time
+            uint64_t iterations = 1;
+            const uint64_t warmup_start = xenon::time::fast_clock::now();
+            for(;;) {
+                const uint64_t start = xenon::time::fast_clock::now();
+                for(uint64_t i = 0; i < iterations; ++i)
+                    func();
+                const uint64_t end = xenon::time::fast_clock::now_ordered();
+                const double batch = xenon::time::fast_clock::to_seconds(end - start);
+                if(batch >= settings.sample_time) {
+                    if(xenon::time::fast_clock::to_seconds(end - warmup_start) >= settings.warmup_time)
+                        break;
+                } else
+                    iterations *= batch > 0 ? std::clamp<uint64_t>(static_cast<uint64_t>(settings.sample_time / batch * 1.2), 2, 1000) : 10;
+            }
+
+            std::vector<double> samples;
+            samples.reserve(settings.samples);
+            for(uint32_t sample = 0; sample < settings.samples; ++sample) {
+                const uint64_t start = xenon::time::fast_clock::now();
+                for(uint64_t i = 0; i < iterations; ++i)
+                    func();
+                const uint64_t end = xenon::time::fast_clock::now_ordered();
+                samples.push_back(xenon::time::fast_clock::to_seconds(end - start) * 1e9 / static_cast<double>(iterations));
+            }
+            return summarize(std::move(name), std::move(samples), iterations, settings.items_per_call, settings.bytes_per_call);
+        }
+
+        /**
+         * @brief A collection of benchmark results that can be printed or saved as JSON and CSV.
+         * @note
+         */
+        class report final {
+        public:
+            /**
+             * @brief Adds a result.
+             * @note
+             * @param  stats: The result
+             * @retval The added result
+             */
+            result& add(result stats) noexcept {
+                return m_results.emplace_back(std::move(stats));
+            }
+
+            /**
+             * @brief Measures a function and adds the result.
+             * @note
+             * @param  name: The name of the benchmark
+             * @param  func: The function
+             * @param  settings: The settings
+             * @retval The added result
+             */
+            template<typename F>
+                requires xenon::concepts::callable<F>
+            result& run(std::string name, F&& func, const options& settings = {}) noexcept {
+                return add(xenon::bench::run(std::move(name), std::forward<F>(func), settings));
+            }
+
+            /**
+             * @brief Gets all the results.
+             * @note
+             * @retval The results
+             */
+            [[nodiscard]] const std::vector<result>& results(void) const noexcept {
+                return m_results;
+            }
+
+            /**
+             * @brief Prints a human readable table.
+             * @note
+             * @param  os: The stream
+             * @retval None
+             */
+            void print(std::ostream& os) const noexcept {
+                char line[256];
+                std::snprintf(line, sizeof(line), "%-40s %14s %14s %12s %16s\n", "name", "median ns", "p99 ns", "mad ns", "items/s");
+                os << line;
+                for(const result& stats : m_results) {
+                    std::snprintf(line, sizeof(line), "%-40s %14.2f %14.2f %12.2f %16.0f", stats.name.c_str(), stats.median, stats.p99, stats.mad, stats.items_per_second);
+                    os << line;
+                    if(stats.bytes_per_second > 0)
+                        os << "  " << stats.bytes_per_second / 1e9 << " GB/s";
+                    for(const auto& [key, value] : stats.counters)
+                        os << "  " << key << '=' << value;
+                    os << '\n';
+                }
+            }
+
+            /**
+             * @brief Formats the results as a JSON array.
+             * @note
+             * @retval The JSON
+             */
+            [[nodiscard]] std::string to_json(void) const noexcept {
+                std::ostringstream os;
+                os.precision(17);
+                os << "[\n";
+                for(size_t i = 0; i < m_results.size(); ++i) {
+                    const result& stats = m_results[i];
+                    os << "  {\"name\": ";
+                    XENON_HF_bench_json_string(os, stats.name);
+                    os << ", \"iterations\": " << stats.iterations << ", \"samples\": " << stats.samples
+                       << ", \"median_ns\": " << stats.median << ", \"p99_ns\": " << stats.p99 << ", \"mad_ns\": " << stats.mad
+                       << ", \"mean_ns\": " << stats.mean << ", \"min_ns\": " << stats.min << ", \"max_ns\": " << stats.max
+                       << ", \"items_per_second\": " << stats.items_per_second << ", \"bytes_per_second\": " << stats.bytes_per_second
+                       << ", \"counters\": {";
+                    for(size_t j = 0; j < stats.counters.size(); ++j) {
+                        XENON_HF_bench_json_string(os, stats.counters[j].first);
+                        os << ": " << stats.counters[j].second << (j + 1 == stats.counters.size() ? "" : ", ");
+                    }
+                    os << "}}" << (i + 1 == m_results.size() ? "\n" : ",\n");
+                }
+                os << "]\n";
+                return os.str();
+            }
+
+            /**
+             * @brief Formats the results as CSV with a header row. Counters go into the last column as key=value pairs separated by semicolons.
+             * @note
+             * @retval The CSV
+             */
+            [[nodiscard]] std::string to_csv(void) const noexcept {
+                std::ostringstream os;
+                os.precision(17);
+                os << "name,iterations,samples,median_ns,p99_ns,mad_ns,mean_ns,min_ns,max_ns,items_per_second,bytes_per_second,counters\n";
+                for(const result& stats : m_results) {
+                    XENON_HF_bench_csv_string(os, stats.name);
+                    os << ',' << stats.iterations << ',' << stats.samples << ',' << stats.median << ',' << stats.p99 << ',' << stats.mad
+                       << ',' << stats.mean << ',' << stats.min << ',' << stats.max << ',' << stats.items_per_second << ',' << stats.bytes_per_second << ',';
+                    std::string counters;
+                    for(const auto& [key, value] : stats.counters)
+                        counters += (counters.empty() ? "" : ";") + key + '=' + std::to_string(value);
+                    XENON_HF_bench_csv_string(os, counters);
+                    os << '\n';
+                }
+                return os.str();
+            }
+
+            /**
+             * @brief Saves the results as JSON.
+             * @note
+             * @param  path: The path for the file
+             * @retval Status of the opened file. True if opened correctly.
+             */
+            bool write_json(const std::string& path) const noexcept {
+                return xenon::files::clear_file(path) && xenon::files::write_file(path, to_json());
+            }
+
+            /**
+             * @brief Saves the results as CSV.
+             * @note
+             * @param  path: The path for the file
+             * @retval Status of the opened file. True if opened correctly.
+             */
+            bool write_csv(const std::string& path) const noexcept {
+                return xenon::files::clear_file(path) && xenon::files::write_file(path, to_csv());
+            }
+        private:
+            std::vector<result> m_results;
+        };
+    } // namespace bench
+} // namespace xenon
+
+#endif // XENON_HG_BENCH_MODULE
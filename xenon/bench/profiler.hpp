@@ -0,0 +1,309 @@
+// profiler.hpp
+//
+// A zone profiler that is a part of a Bench module.
+// Zones are recorded with XENON_PROFILE_ZONE, which compiles to nothing unless XENON_M_PROFILE is defined.
+
+#ifndef XENON_HG_BENCH_PROFILER
+#define XENON_HG_BENCH_PROFILER
+
+// Libraries
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+// Xenon's Modules
+#include "../macros.hpp"
+#include "../time/fast_clock.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    inline void XENON_HF_profiler_json_string(std::string& out, const char* str) noexcept {
+        out += '"';
+        for(; *str != '\0'; ++str) {
+            if(*str == '"' || *str == '\\') {
+                out += '\\';
+                out += *str;
+            } else if(static_cast<unsigned char>(*str) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*str));
+                out += escaped;
+            } else
+                out += *str;
+        }
+        out += '"';
+    }
+}
+
+namespace xenon {
+    namespace bench {
+        /**
+         * @brief Collects zones from every thread and writes them into a Chrome trace file(chrome://tracing, Perfetto).
+         * @note   Each thread records into its own fixed ring buffer without locks or allocations, and a background thread drains the buffers into the file.
+         *         Zones that don't fit into a full buffer are dropped and counted rather than blocking the thread.
+         */
+        class profiler final {
+        public:
+            /**
+             * @brief Amount of zones a thread can have recorded before the background thread drains them.
+             * @note
+             */
+            static constexpr size_t buffer_capacity = 1 << 14;
+
+            /**
+             * @brief Gets the global profiler that XENON_PROFILE_ZONE records into.
+             * @note
+             * @retval The profiler
+             */
+            [[nodiscard]] static profiler& instance(void) noexcept {
+                // Leaked on purpose so that zones in threads that outlive main() still have somewhere to go
+                static profiler* global = new profiler();
+                return *global;
+            }
+
+            /**
+             * @brief Opens a trace file and starts recording zones into it.
+             * @note
+             * @param  path: The path for the trace file
+             * @param  flush_interval: How often the background thread drains the buffers, in milliseconds
+             * @retval False if it's already recording or the file couldn't be opened
+             */
+            bool start(const std::string& path, const uint32_t flush_interval = 100) noexcept {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if(m_running.load(std::memory_order_relaxed)) [[unlikely]]
+                    return false;
+                m_file.open(path, std::ios_base::out | std::ios_base::trunc);
+                if(!m_file.good() || !m_file.is_open()) [[unlikely]]
+                    return false;
+                m_file << "{\"traceEvents\":[";
+                m_first_event = true;
+
+                // Zones left over from before are discarded, and the clock is calibrated here instead of inside the first zone
+                for(const std::unique_ptr<thread_buffer>& buffer : m_buffers)
+                    buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+                m_origin = xenon::time::fast_clock::now();
+                m_stopping = false;
+                m_running.store(true, std::memory_order_release);
+                m_drain = std::thread([this, flush_interval]() {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    while(!m_stopping) {
+                        m_wakeup.wait_for(lock, std::chrono::milliseconds(flush_interval), [this]() { return m_stopping; });
+                        std::string text = drain();
+                        // Only this thread writes to the file while recording, so the zones are written outside the lock
+                        lock.unlock();
+                        m_file << text;
+                        lock.lock();
+                    }
+                });
+                return true;
+            }
+
+            /**
+             * @brief Stops recording, writes every zone that is left and closes the trace file.
+             * @note
+             * @retval None
+             */
+            void stop(void) noexcept {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if(!m_running.load(std::memory_order_relaxed)) [[unlikely]]
+                        return;
+                    m_running.store(false, std::memory_order_release);
+                    m_stopping = true;
+                }
+                m_wakeup.notify_all();
+                m_drain.join();
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_file << drain() << "\n]}\n";
+                m_file.close();
+            }
+
+            /**
+             * @brief Checks whether zones are being recorded.
+             * @note
+             * @retval True if recording
+             */
+            [[nodiscard]] bool running(void) const noexcept {
+                return m_running.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Gets the amount of zones that were dropped because a thread's buffer was full.
+             * @note
+             * @retval Amount of dropped zones
+             */
+            [[nodiscard]] uint64_t dropped(void) noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                uint64_t count = m_dropped;
+                for(const std::unique_ptr<thread_buffer>& buffer : m_buffers)
+                    count += buffer->dropped.load(std::memory_order_relaxed);
+                return count;
+            }
+
+            /**
+             * @brief Records a zone of the calling thread.
+             * @note   Doesn't lock or allocate, apart from registering the thread the first time it records.
+             * @param  name: The name of the zone. Has to stay alive until the profiler stops, e.g. a string literal
+             * @param  begin: fast_clock::now() at the start of the zone
+             * @param  end: fast_clock::now() at the end of the zone
+             * @retval None
+             */
+            void record(const char* name, const uint64_t begin, const uint64_t end) noexcept {
+                if(!m_running.load(std::memory_order_relaxed)) [[unlikely]]
+                    return;
+                thread_buffer* const local = local_buffer();
+                if(local == nullptr) [[unlikely]]
+                    return;
+                thread_buffer& buffer = *local;
+                const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+                if(head - buffer.tail.load(std::memory_order_acquire) == buffer_capacity) [[unlikely]] {
+                    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                buffer.events[head & (buffer_capacity - 1)] = { name, begin, end };
+                buffer.head.store(head + 1, std::memory_order_release);
+            }
+        private:
+            static_assert((buffer_capacity & (buffer_capacity - 1)) == 0, "buffer_capacity has to be a power of two");
+
+            struct event {
+                const char* name;
+                uint64_t begin;
+                uint64_t end;
+            };
+
+            // Written by its thread at the head and by the drain at the tail
+            struct thread_buffer {
+                std::array<event, buffer_capacity> events;
+                alignas(64) std::atomic<uint64_t> head = 0;
+                std::atomic<uint64_t> dropped = 0;
+                alignas(64) std::atomic<uint64_t> tail = 0;
+                std::atomic<bool> retired = false;
+                uint32_t thread_id = 0;
+            };
+
+            // Marks the buffer as retired when its thread exits, so the drain can free it once it's empty.
+            // Zones in thread_local destructors that run after this one aren't recorded, since the drain may have freed the buffer by then
+            struct thread_handle {
+                thread_buffer* buffer = nullptr;
+                bool exited = false;
+
+                ~thread_handle(void) noexcept {
+                    if(buffer != nullptr)
+                        buffer->retired.store(true, std::memory_order_release);
+                    buffer = nullptr;
+                    exited = true;
+                }
+            };
+
+            profiler(void) noexcept = default;
+
+            // Null once the thread has started tearing down its thread_locals
+            thread_buffer* local_buffer(void) noexcept {
+                static thread_local thread_handle handle;
+                if(handle.buffer == nullptr) [[unlikely]] {
+                    if(handle.exited)
+                        return nullptr;
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    handle.buffer = m_buffers.emplace_back(std::make_unique<thread_buffer>()).get();
+                    handle.buffer->thread_id = m_next_thread_id++;
+                }
+                return handle.buffer;
+            }
+
+            // Expects m_mutex to be locked
+            std::string drain(void) noexcept {
+                std::string text;
+                char line[96];
+                for(size_t i = 0; i < m_buffers.size();) {
+                    thread_buffer& buffer = *m_buffers[i];
+                    // Read before the head, so a retired buffer is known to have nothing after it
+                    const bool retired = buffer.retired.load(std::memory_order_acquire);
+                    const uint64_t head = buffer.head.load(std::memory_order_acquire);
+                    for(uint64_t tail = buffer.tail.load(std::memory_order_relaxed); tail != head; ++tail) {
+                        const event& zone = buffer.events[tail & (buffer_capacity - 1)];
+                        text += m_first_event ? "\n{\"name\":" : ",\n{\"name\":";
+                        m_first_event = false;
+                        XENON_HF_profiler_json_string(text, zone.name);
+                        std::snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                            buffer.thread_id, since_origin(zone.begin), xenon::time::fast_clock::to_seconds(zone.end - zone.begin) * 1e6);
+                        text += line;
+                    }
+                    buffer.tail.store(head, std::memory_order_release);
+
+                    if(retired) [[unlikely]] {
+                        m_dropped += buffer.dropped.load(std::memory_order_relaxed);
+                        m_buffers[i] = std::move(m_buffers.back());
+                        m_buffers.pop_back();
+                    } else
+                        ++i;
+                }
+                return text;
+            }
+
+            // Microseconds, which is what the trace format expects. Zones that started before start() are negative
+            double since_origin(const uint64_t ticks) const noexcept {
+                return ticks >= m_origin ? xenon::time::fast_clock::to_seconds(ticks - m_origin) * 1e6 : -xenon::time::fast_clock::to_seconds(m_origin - ticks) * 1e6;
+            }
+
+            std::atomic<bool> m_running = false;
+
+            std::mutex m_mutex;
+            std::condition_variable m_wakeup;
+            bool m_stopping = false;
+            std::thread m_drain;
+
+            std::vector<std::unique_ptr<thread_buffer>> m_buffers;
+            uint32_t m_next_thread_id = 0;
+            uint64_t m_dropped = 0;
+
+            std::ofstream m_file;
+            bool m_first_event = true;
+            uint64_t m_origin = 0;
+        };
+
+        /**
+         * @brief Records the time from its construction to its destruction as a zone. Use XENON_PROFILE_ZONE instead of creating it directly.
+         * @note   Costs one relaxed load when the profiler isn't running.
+         */
+        class zone final {
+        public:
+            /**
+             * @brief Starts the zone.
+             * @note
+             * @param  name: The name of the zone. Has to stay alive until the profiler stops, e.g. a string literal
+             */
+            explicit zone(const char* name) noexcept
+                : m_name(name), m_active(profiler::instance().running()), m_begin(m_active ? xenon::time::fast_clock::now() : 0) {}
+
+            /**
+             * @brief Ends the zone and records it.
+             * @note
+             */
+            ~zone(void) noexcept {
+                if(m_active)
+                    profiler::instance().record(m_name, m_begin, xenon::time::fast_clock::now());
+            }
+
+            zone(const zone&) = delete;
+            zone& operator=(const zone&) = delete;
+        private:
+            const char* m_name;
+            bool m_active;
+            uint64_t m_begin;
+        };
+    } // namespace bench
+} // namespace xenon
+
+#endif // XENON_HG_BENCH_PROFILER
@@ -0,0 +1,303 @@
+// suites.hpp
+//
+// Benchmarks of Xenon's own modules that are a part of a Bench module.
+// Must be included explicitly, since it pulls in every module it measures.
+
+#ifndef XENON_HG_BENCH_SUITES
+#define XENON_HG_BENCH_SUITES
+
+// Libraries
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <cstdint>
+
+// Other parts of the Bench component
+#include "bench.hpp"
+
+// Xenon's Modules
+#include "../async/async.hpp"
+#include "../files/files.hpp"
+#include "../random/random.hpp"
+#include "../time/time.hpp"
+#include "../utilities/utilities.hpp"
+
+namespace xenon {
+    namespace bench {
+        namespace suites {
+            /**
+             * @brief Measures how many numbers a generator draws per nanosecond.
+             * @note
+             * @param  out: The report to add the results to
+             * @param  name: The name of the generator
+             * @retval None
+             */
+            template<typename G>
+            inline void generator(report& out, const std::string& name) noexcept {
+                constexpr uint64_t draws = 4096;
+                G gen;
+                options settings;
+                settings.items_per_call = draws;
+                result& stats = out.run("random/" + name, [&]() {
+                    uint64_t sum = 0;
+                    for(uint64_t i = 0; i < draws; ++i)
+                        sum += gen();
+                    do_not_optimize(sum);
+                }, settings);
+                stats.counters.emplace_back("draws_per_ns", stats.items_per_second / 1e9);
+            }
+
+            /**
+             * @brief Measures the generators and random_engine.
+             * @note   std::mt19937_64 is there to compare against.
+             * @param  out: The report to add the results to
+             * @retval None
+             */
+            inline void random(report& out) noexcept {
+                generator<std::mt19937_64>(out, "mt19937_64");
+                generator<xenon::random::xoshiro256ss>(out, "xoshiro256**");
+                generator<xenon::random::pcg64>(out, "pcg64");
+                generator<xenon::random::wyrand>(out, "wyrand");
+
+                xenon::random::random_engine engine;
+                out.run("random/get_integral", [&]() { do_not_optimize(engine.get_integral<uint32_t>(0, 1000)); });
+                out.run("random/get_floating_point", [&]() { do_not_optimize(engine.get_floating_point<double>(0.0, 1.0)); });
+                out.run("random/get_string(20)", [&]() { do_not_optimize(engine.get_string(20)); });
+                out.run("random/get_uuid", [&]() { do_not_optimize(engine.get_uuid()); });
+                out.run("random/get_uuid_v4", [&]() { do_not_optimize(engine.get_uuid_v4()); });
+                out.run("random/get_uuid_v7", [&]() { do_not_optimize(engine.get_uuid_v7()); });
+
+                std::vector<uint32_t> integers(1 << 20);
+                std::vector<double> doubles(1 << 20);
+                options settings;
+                settings.samples = 11;
+                settings.items_per_call = integers.size();
+                settings.bytes_per_call = integers.size() * sizeof(uint32_t);
+                out.run("random/fill_integral<uint32_t>", [&]() {
+                    engine.fill_integral<uint32_t>(integers, 0, 1000);
+                    clobber_memory();
+                }, settings);
+                settings.bytes_per_call = doubles.size() * sizeof(double);
+                out.run("random/fill_floating_point<double>", [&]() {
+                    engine.fill_floating_point<double>(doubles, 0.0, 1.0);
+                    clobber_memory();
+                }, settings);
+            }
+
+            /**
+             * @brief Measures reading a file with the files module.
+             * @note   Writes a scratch file of about 8 megabytes into the directory and removes it afterwards.
+             * @param  out: The report to add the results to
+             * @param  directory: A directory for the scratch file
+             * @retval None
+             */
+            inline void files(report& out, const std::string& directory = std::filesystem::temp_directory_path().string()) noexcept {
+                const std::string path = (std::filesystem::path(directory) / "xenon_bench_files.txt").string();
+                std::vector<std::string> lines(128 * 1024, std::string(63, 'x'));
+                std::error_code error;
+                if(!xenon::files::clear_file(path) || !xenon::files::write_file(path, lines)) [[unlikely]]
+                    return;
+                const uint64_t bytes = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+
+                options settings;
+                settings.samples = 11;
+                settings.bytes_per_call = bytes;
+                out.run("files/read_file", [&]() { do_not_optimize(xenon::files::read_file(path)); }, settings);
+                out.run("files/read_file_lines", [&]() { do_not_optimize(xenon::files::read_file_lines(path)); }, settings);
+                out.run("files/count_lines", [&]() { do_not_optimize(xenon::files::count_lines(path)); }, settings);
+
+                std::filesystem::remove(path, error);
+            }
+
+            /**
+             * @brief Measures how many gigabytes of text count_newlines gets through per second.
+             * @note   Counts a buffer that fits in the last level cache and one that is big enough to be split across threads.
+             * @param  out: The report to add the results to
+             * @retval None
+             */
+            inline void newlines(report& out) noexcept {
+                for(const size_t bytes : { size_t(1) << 20, xenon::files::parallel_count_threshold * 2 }) {
+                    std::string text(bytes, 'x');
+                    for(size_t i = 63; i < text.size(); i += 64)
+                        text[i] = '\n';
+                    options settings;
+                    settings.samples = 11;
+                    settings.bytes_per_call = bytes;
+                    out.run("files/count_newlines/bytes:" + std::to_string(bytes), [&]() { do_not_optimize(xenon::files::count_newlines(text)); }, settings);
+                }
+            }
+
+            /**
+             * @brief Measures how many gigabytes per second each hash function of hash_buffer gets through.
+             * @note   Hashes a buffer that fits in the last level cache and one that is big enough to be split across threads.
+             * @param  out: The report to add the results to
+             * @retval None
+             */
+            inline void hashing(report& out) noexcept {
+                for(const size_t bytes : { size_t(1) << 20, xenon::files::parallel_hash_threshold * 2 }) {
+                    std::string data(bytes, '\0');
+                    for(size_t i = 0; i < data.size(); ++i)
+                        data[i] = static_cast<char>(i % 251);
+                    options settings;
+                    settings.samples = 11;
+                    settings.bytes_per_call = bytes;
+                    for(const auto& [name, algorithm] : { std::pair("xxh3", xenon::files::hash_algorithm::xxh3), std::pair("crc32c", xenon::files::hash_algorithm::crc32c), std::pair("blake3", xenon::files::hash_algorithm::blake3) })
+                        out.run(std::string("files/hash_buffer/") + name + "/bytes:" + std::to_string(bytes), [&]() { do_not_optimize(xenon::files::hash_buffer(data, algorithm)); }, settings);
+                }
+            }
+
+            /**
+             * @brief Measures the Vector classes.
+             * @note
+             * @param  out: The report to add the results to
+             * @retval None
+             */
+            inline void utilities(report& out) noexcept {
+                using vector3_t = xenon::utilities::Vector3<float>;
+                std::vector<vector3_t> vectors(1024, vector3_t{ 1.0f, 2.0f, 3.0f });
+                options settings;
+                settings.items_per_call = vectors.size();
+                out.run("utilities/Vector3<float>::operator+", [&]() {
+                    for(vector3_t& vec : vectors)
+                        vec = vec + vector3_t{ 0.5f, 0.25f, 0.125f };
+                    clobber_memory();
+                }, settings);
+                out.run("utilities/Vector3<float>::operator*", [&]() {
+                    for(vector3_t& vec : vectors)
+                        vec = vec * vector3_t{ 1.0f, 0.5f, 2.0f };
+                    clobber_memory();
+                }, settings);
+            }
+
+            /**
+             * @brief Measures tasks per second of async::run against starting and detaching a thread per task.
+             * @note
+             * @param  out: The report to add the results to
+             * @param  tasks: How many tasks one call starts and waits for
+             * @retval None
+             */
+            inline void async(report& out, const uint32_t tasks = 1000) noexcept {
+                options settings;
+                settings.samples = 11;
+                settings.items_per_call = tasks;
+                // Shared with the tasks, because a detached thread can still be inside notify_all() after this function returns
+                const std::shared_ptr<std::atomic<uint32_t>> done = std::make_shared<std::atomic<uint32_t>>(0);
+                const auto wait_for = [&done](const uint32_t count) {
+                    for(uint32_t now = done->load(std::memory_order_acquire); now != count; now = done->load(std::memory_order_acquire))
+                        done->wait(now, std::memory_order_acquire);
+                    done->store(0, std::memory_order_relaxed);
+                };
+                const auto task = [done, tasks]() {
+                    if(done->fetch_add(1, std::memory_order_acq_rel) + 1 == tasks)
+                        done->notify_all();
+                };
+
+                out.run("async/detached_threads", [&]() {
+                    for(uint32_t i = 0; i < tasks; ++i)
+                        std::thread(task).detach();
+                    wait_for(tasks);
+                }, settings);
+                out.run("async/thread_pool::submit", [&]() {
+                    for(uint32_t i = 0; i < tasks; ++i)
+                        xenon::async::default_pool().submit(task);
+                    wait_for(tasks);
+                }, settings);
+                out.run("async/run", [&]() {
+                    for(uint32_t i = 0; i < tasks; ++i)
+                        xenon::async::run(task);
+                    wait_for(tasks);
+                }, settings);
+            }
+
+            /**
+             * @brief Measures how parallel_reduce scales from 1 to all hardware threads.
+             * @note
+             * @param  out: The report to add the results to
+             * @param  elements: Amount of Vector3<float> to reduce
+             * @retval None
+             */
+            inline void parallel(report& out, const size_t elements = 1 << 20) noexcept {
+                using vector3_t = xenon::utilities::Vector3<float>;
+                std::vector<vector3_t> vectors(elements, vector3_t{ 1.0f, 2.0f, 3.0f });
+                options settings;
+                settings.samples = 11;
+                settings.items_per_call = elements;
+                settings.bytes_per_call = elements * sizeof(vector3_t);
+                const uint32_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+                std::vector<uint32_t> thread_counts;
+                for(uint32_t threads = 1; threads < max_threads; threads *= 2)
+                    thread_counts.push_back(threads);
+                thread_counts.push_back(max_threads);
+                for(const uint32_t threads : thread_counts) {
+                    xenon::async::thread_pool pool(threads);
+                    out.run("async/parallel_reduce/threads:" + std::to_string(threads), [&]() {
+                        do_not_optimize(xenon::async::parallel_reduce(vectors, 0.0f, [](const float sum, const auto& value) {
+                            if constexpr(std::is_same_v<std::decay_t<decltype(value)>, vector3_t>)
+                                return sum + value.x + value.y + value.z;
+                            else
+                                return sum + value;
+                        }, 0, pool));
+                    }, settings);
+                }
+            }
+
+            /**
+             * @brief Measures how late timeouts fire and how much memory a pending timer takes.
+             * @note   The samples are lateness of each timer rather than time per call.
+             * @param  out: The report to add the results to
+             * @param  timers: Amount of timeouts to schedule at once
+             * @retval None
+             */
+            inline void timers(report& out, const uint32_t timers = 10000) noexcept {
+                // Declared before the scheduler, so they outlive its thread, which can still be in notify_all after the wait returns
+                std::vector<double> lateness(timers);
+                std::atomic<uint32_t> done = 0;
+                xenon::time::timer_scheduler scheduler;
+                const size_t memory_before = scheduler.memory_usage();
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for(uint32_t i = 0; i < timers; ++i) {
+                    const uint32_t delay = 10 + i % 500;
+                    scheduler.schedule(delay, [&, i, delay, start]() {
+                        const std::chrono::steady_clock::time_point deadline = start + std::chrono::milliseconds(delay);
+                        lateness[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - deadline).count();
+                        if(done.fetch_add(1, std::memory_order_acq_rel) + 1 == timers)
+                            done.notify_all();
+                    });
+                }
+                const double bytes_per_timer = static_cast<double>(scheduler.memory_usage() - memory_before) / timers;
+                for(uint32_t now = done.load(std::memory_order_acquire); now != timers; now = done.load(std::memory_order_acquire))
+                    done.wait(now, std::memory_order_acquire);
+
+                result& stats = out.add(summarize("time/timer_scheduler/lateness", std::move(lateness)));
+                stats.counters.emplace_back("bytes_per_timer", bytes_per_timer);
+            }
+
+            /**
+             * @brief Runs every suite.
+             * @note
+             * @param  directory: A directory for scratch files
+             * @retval The report
+             */
+            [[nodiscard]] inline report run_all(const std::string& directory = std::filesystem::temp_directory_path().string()) noexcept {
+                report out;
+                random(out);
+                files(out, directory);
+                newlines(out);
+                hashing(out);
+                utilities(out);
+                async(out);
+                parallel(out);
+                timers(out);
+                return out;
+            }
+        } // namespace suites
+    } // namespace bench
+} // namespace xenon
+
+#endif // XENON_HG_BENCH_SUITES
@@ -0,0 +1,539 @@
+// async_io.hpp
+//
+// Asynchronous file reading and writing that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_ASYNC_IO
+#define XENON_HG_FILES_ASYNC_IO
+
+#include "../macros.hpp"
+
+// Libraries
+#include <span>
+#include <string>
+#include <vector>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef XENON_M_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif // XENON_M_IO_URING
+
+// Other parts of the Files component
+#include "mapped_file.hpp"
+#include "writer.hpp"
+
+// Xenon's Modules
+#include "../async/async.hpp"
+#include "../concepts/concepts.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    inline bool XENON_HF_write_whole(const std::string& path, const std::string& content, const xenon::files::writing_mode open_mode) noexcept {
+        xenon::files::writer file(path, open_mode, xenon::files::durability::none, xenon::files::writer::direct_alignment);
+        return file.write(content) && file.close();
+    }
+
+#ifdef XENON_M_IO_URING
+    /**
+     * @brief One file being read or written. Only one of its operations is in the ring at a time.
+     */
+    struct XENON_HF_io_request {
+        enum class stage {
+            open,
+            transfer,
+            close
+        };
+
+        stage step = stage::open;
+        bool writing = false;
+        bool appending = false;
+        bool failed = false;
+        int fd = -1;
+        // A registered buffer the transfer goes through, or -1
+        int slot = -1;
+        size_t done = 0;
+        // Size of the file being read, 0 if it's unknown
+        size_t expected = 0;
+        std::string path;
+        std::string data;
+        std::optional<xenon::async::promise<std::optional<std::string>>> read_done;
+        std::optional<xenon::async::promise<bool>> write_done;
+    };
+
+    /**
+     * @brief An io_uring driven by one thread, talking to the kernel through the raw system calls.
+     * @note   Callers queue requests and wake the thread through an eventfd that has a read in the ring, so every request that piled up goes in with one io_uring_enter.
+     *         Small transfers go through registered buffers, so the kernel doesn't have to pin pages for every operation.
+     */
+    class XENON_HF_io_ring final {
+    public:
+        static constexpr uint32_t entries = 256;
+        static constexpr size_t slot_count = 64;
+        static constexpr size_t slot_size = size_t(64) << 10;
+
+        /**
+         * @brief The process-wide ring, or null if the kernel refuses io_uring(too old, or blocked by seccomp).
+         */
+        static XENON_HF_io_ring* instance(void) noexcept {
+            static XENON_HF_io_ring* const ring = []() -> XENON_HF_io_ring* {
+                XENON_HF_io_ring* const created = new XENON_HF_io_ring();
+                if(created->m_ready)
+                    return created;
+                delete created;
+                return nullptr;
+            }();
+            return ring;
+        }
+
+        void submit(std::vector<XENON_HF_io_request*>& requests) noexcept {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pending.insert(m_pending.end(), requests.begin(), requests.end());
+            }
+            const uint64_t one = 1;
+            while(::write(m_wake, &one, sizeof(one)) < 0 && errno == EINTR);
+        }
+    private:
+        XENON_HF_io_ring(void) noexcept {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            m_ring = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if(m_ring < 0 || !supports_opcodes())
+                return;
+            m_sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+            m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if(params.features & IORING_FEAT_SINGLE_MMAP)
+                m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+            void* const sq = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+            if(sq == MAP_FAILED)
+                return;
+            m_sq = static_cast<char*>(sq);
+            if(params.features & IORING_FEAT_SINGLE_MMAP)
+                m_cq = m_sq;
+            else {
+                void* const cq = mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+                if(cq == MAP_FAILED)
+                    return;
+                m_cq = static_cast<char*>(cq);
+            }
+            void* const sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+            if(sqes == MAP_FAILED)
+                return;
+            m_sqes = static_cast<io_uring_sqe*>(sqes);
+            m_sq_entries = params.sq_entries;
+            m_cq_entries = params.cq_entries;
+            m_sq_head = reinterpret_cast<uint32_t*>(m_sq + params.sq_off.head);
+            m_sq_tail = reinterpret_cast<uint32_t*>(m_sq + params.sq_off.tail);
+            m_sq_mask = *reinterpret_cast<uint32_t*>(m_sq + params.sq_off.ring_mask);
+            m_cq_head = reinterpret_cast<uint32_t*>(m_cq + params.cq_off.head);
+            m_cq_tail = reinterpret_cast<uint32_t*>(m_cq + params.cq_off.tail);
+            m_cq_mask = *reinterpret_cast<uint32_t*>(m_cq + params.cq_off.ring_mask);
+            m_cqes = reinterpret_cast<io_uring_cqe*>(m_cq + params.cq_off.cqes);
+            // Every slot of the submission array points at the entry with the same index, so entries are used in ring order
+            uint32_t* const array = reinterpret_cast<uint32_t*>(m_sq + params.sq_off.array);
+            for(uint32_t i = 0; i < m_sq_entries; ++i)
+                array[i] = i;
+            m_tail = *m_sq_tail;
+
+            m_wake = eventfd(0, EFD_CLOEXEC);
+            if(m_wake < 0)
+                return;
+
+            // Registering can fail under a low RLIMIT_MEMLOCK, in which case every transfer goes to the string directly
+            m_slots = static_cast<char*>(::operator new(slot_count * slot_size, std::align_val_t(4096), std::nothrow));
+            if(m_slots != nullptr) {
+                iovec vectors[slot_count];
+                for(size_t i = 0; i < slot_count; ++i)
+                    vectors[i] = { m_slots + i * slot_size, slot_size };
+                if(syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_BUFFERS, vectors, slot_count) == 0)
+                    for(size_t i = 0; i < slot_count; ++i)
+                        m_free_slots.push_back(static_cast<int>(i));
+            }
+
+            m_ready = true;
+            std::thread([this]() { run(); }).detach();
+        }
+
+        /**
+         * @brief Whether the kernel knows every operation the ring sends.
+         * @note   5.1 to 5.5 set rings up fine, but complete OPENAT, READ, WRITE and CLOSE with -EINVAL. They don't have IORING_REGISTER_PROBE either, so a failed probe counts as unsupported.
+         */
+        bool supports_opcodes(void) const noexcept {
+            constexpr size_t op_count = 256;
+            alignas(io_uring_probe) char storage[sizeof(io_uring_probe) + op_count * sizeof(io_uring_probe_op)] = {};
+            io_uring_probe* const probe = reinterpret_cast<io_uring_probe*>(storage);
+            if(syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_PROBE, probe, op_count) != 0)
+                return false;
+            for(const int opcode : { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED })
+                if(opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED))
+                    return false;
+            return true;
+        }
+
+        ~XENON_HF_io_ring(void) noexcept {
+            if(m_wake >= 0)
+                ::close(m_wake);
+            if(m_slots != nullptr)
+                ::operator delete(m_slots, std::align_val_t(4096));
+            if(m_sqes != nullptr)
+                munmap(m_sqes, m_sq_entries * sizeof(io_uring_sqe));
+            if(m_cq != nullptr && m_cq != m_sq)
+                munmap(m_cq, m_cq_size);
+            if(m_sq != nullptr)
+                munmap(m_sq, m_sq_size);
+            if(m_ring >= 0)
+                ::close(m_ring);
+        }
+
+        io_uring_sqe* next_sqe(void) noexcept {
+            if(m_tail - std::atomic_ref<uint32_t>(*m_sq_head).load(std::memory_order_acquire) == m_sq_entries)
+                enter(0);
+            io_uring_sqe* const sqe = &m_sqes[m_tail & m_sq_mask];
+            std::memset(sqe, 0, sizeof(io_uring_sqe));
+            ++m_tail;
+            ++m_to_submit;
+            return sqe;
+        }
+
+        void enter(const uint32_t wait) noexcept {
+            std::atomic_ref<uint32_t>(*m_sq_tail).store(m_tail, std::memory_order_release);
+            for(;;) {
+                const long submitted = syscall(__NR_io_uring_enter, m_ring, m_to_submit, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if(submitted >= 0) {
+                    m_to_submit -= static_cast<uint32_t>(submitted);
+                    return;
+                }
+                // EAGAIN and EBUSY mean completions have to be reaped first, the entries stay queued until the next call
+                if(errno != EINTR)
+                    return;
+            }
+        }
+
+        void arm_wake(void) noexcept {
+            io_uring_sqe* const sqe = next_sqe();
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = m_wake;
+            sqe->addr = reinterpret_cast<uint64_t>(&m_wake_value);
+            sqe->len = sizeof(m_wake_value);
+            sqe->user_data = 0;
+        }
+
+        void queue(XENON_HF_io_request* request) noexcept {
+            io_uring_sqe* const sqe = next_sqe();
+            sqe->user_data = reinterpret_cast<uint64_t>(request);
+            switch(request->step) {
+            case XENON_HF_io_request::stage::open:
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(request->path.c_str());
+                sqe->len = 0644;
+                sqe->open_flags = request->writing ? (O_WRONLY | O_CREAT | O_CLOEXEC | (request->appending ? O_APPEND : O_TRUNC)) : (O_RDONLY | O_CLOEXEC);
+                break;
+            case XENON_HF_io_request::stage::transfer:
+                sqe->fd = request->fd;
+                // Appends go after whatever the end is by then
+                sqe->off = request->writing && request->appending ? ~uint64_t(0) : request->done;
+                if(request->writing) {
+                    if(request->slot >= 0) {
+                        sqe->opcode = IORING_OP_WRITE_FIXED;
+                        sqe->buf_index = static_cast<uint16_t>(request->slot);
+                        sqe->addr = reinterpret_cast<uint64_t>(m_slots + static_cast<size_t>(request->slot) * slot_size + request->done);
+                    } else {
+                        sqe->opcode = IORING_OP_WRITE;
+                        sqe->addr = reinterpret_cast<uint64_t>(request->data.data() + request->done);
+                    }
+                    sqe->len = static_cast<uint32_t>(std::min<size_t>(request->data.size() - request->done, 1u << 30));
+                } else if(request->slot >= 0) {
+                    sqe->opcode = IORING_OP_READ_FIXED;
+                    sqe->buf_index = static_cast<uint16_t>(request->slot);
+                    sqe->addr = reinterpret_cast<uint64_t>(m_slots + static_cast<size_t>(request->slot) * slot_size);
+                    sqe->len = static_cast<uint32_t>(slot_size);
+                } else {
+                    // Doubles the string when the size is unknown, so such a file takes a logarithmic amount of reads
+                    if(request->data.size() == request->done)
+                        request->data.resize(request->done + std::max(slot_size, request->done));
+                    sqe->opcode = IORING_OP_READ;
+                    sqe->addr = reinterpret_cast<uint64_t>(request->data.data() + request->done);
+                    sqe->len = static_cast<uint32_t>(std::min<size_t>(request->data.size() - request->done, 1u << 30));
+                }
+                break;
+            case XENON_HF_io_request::stage::close:
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = request->fd;
+                break;
+            }
+        }
+
+        void start(XENON_HF_io_request* request) noexcept {
+            ++m_in_flight;
+            // A small write is copied into a registered buffer once, a read borrows one for its first block
+            if(!m_free_slots.empty() && (!request->writing || request->data.size() <= slot_size)) {
+                request->slot = m_free_slots.back();
+                m_free_slots.pop_back();
+                if(request->writing)
+                    std::memcpy(m_slots + static_cast<size_t>(request->slot) * slot_size, request->data.data(), request->data.size());
+            }
+            queue(request);
+        }
+
+        void release_slot(XENON_HF_io_request* request) noexcept {
+            if(request->slot >= 0) {
+                m_free_slots.push_back(request->slot);
+                request->slot = -1;
+            }
+        }
+
+        void finish(XENON_HF_io_request* request) noexcept {
+            release_slot(request);
+            --m_in_flight;
+            if(request->writing)
+                request->write_done->set_value(!request->failed);
+            else if(request->failed)
+                request->read_done->set_value(std::nullopt);
+            else {
+                request->data.resize(request->done);
+                request->read_done->set_value(std::move(request->data));
+            }
+            delete request;
+        }
+
+        void complete(XENON_HF_io_request* request, const int32_t result) noexcept {
+            switch(request->step) {
+            case XENON_HF_io_request::stage::open:
+                if(result < 0) {
+                    request->failed = true;
+                    finish(request);
+                    return;
+                }
+                request->fd = result;
+                request->step = XENON_HF_io_request::stage::transfer;
+                if(!request->writing) {
+                    // The inode is in memory right after the open, so asking for the size doesn't block. A size of 0 is unknown rather than empty(/proc and such)
+                    struct stat info;
+                    if(fstat(request->fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+                        request->expected = static_cast<size_t>(info.st_size);
+                        if(request->expected > slot_size) {
+                            release_slot(request);
+                            request->data.resize(request->expected);
+                        }
+                    }
+                }
+                if(request->writing && request->data.empty())
+                    request->step = XENON_HF_io_request::stage::close;
+                queue(request);
+                return;
+            case XENON_HF_io_request::stage::transfer:
+                if(result < 0) {
+                    request->failed = true;
+                    request->step = XENON_HF_io_request::stage::close;
+                } else if(request->writing) {
+                    request->done += static_cast<size_t>(result);
+                    if(request->done == request->data.size() || result == 0) {
+                        request->failed = request->done != request->data.size();
+                        request->step = XENON_HF_io_request::stage::close;
+                    }
+                } else if(request->slot >= 0) {
+                    request->data.assign(m_slots + static_cast<size_t>(request->slot) * slot_size, static_cast<size_t>(result));
+                    request->done = static_cast<size_t>(result);
+                    release_slot(request);
+                    if(result == 0 || (request->expected > 0 && request->done >= request->expected))
+                        request->step = XENON_HF_io_request::stage::close;
+                } else {
+                    request->done += static_cast<size_t>(result);
+                    if(result == 0 || (request->expected > 0 && request->done >= request->expected))
+                        request->step = XENON_HF_io_request::stage::close;
+                }
+                queue(request);
+                return;
+            case XENON_HF_io_request::stage::close:
+                finish(request);
+                return;
+            }
+        }
+
+        void run(void) noexcept {
+            arm_wake();
+            std::vector<XENON_HF_io_request*> waiting;
+            size_t next_waiting = 0;
+            for(;;) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    waiting.insert(waiting.end(), m_pending.begin(), m_pending.end());
+                    m_pending.clear();
+                }
+                // One operation per request is in the ring, so capping the requests keeps the completion queue from overflowing
+                while(next_waiting < waiting.size() && m_in_flight + 1 < m_cq_entries / 2)
+                    start(waiting[next_waiting++]);
+                if(next_waiting == waiting.size()) {
+                    waiting.clear();
+                    next_waiting = 0;
+                }
+
+                enter(1);
+                uint32_t head = *m_cq_head;
+                const uint32_t tail = std::atomic_ref<uint32_t>(*m_cq_tail).load(std::memory_order_acquire);
+                for(; head != tail; ++head) {
+                    const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+                    if(cqe.user_data == 0)
+                        arm_wake();
+                    else
+                        complete(reinterpret_cast<XENON_HF_io_request*>(cqe.user_data), cqe.res);
+                }
+                std::atomic_ref<uint32_t>(*m_cq_head).store(head, std::memory_order_release);
+            }
+        }
+
+        int m_ring = -1;
+        int m_wake = -1;
+        uint64_t m_wake_value = 0;
+        char* m_sq = nullptr;
+        char* m_cq = nullptr;
+        size_t m_sq_size = 0;
+        size_t m_cq_size = 0;
+        io_uring_sqe* m_sqes = nullptr;
+        io_uring_cqe* m_cqes = nullptr;
+        uint32_t* m_sq_head = nullptr;
+        uint32_t* m_sq_tail = nullptr;
+        uint32_t* m_cq_head = nullptr;
+        uint32_t* m_cq_tail = nullptr;
+        uint32_t m_sq_mask = 0;
+        uint32_t m_cq_mask = 0;
+        uint32_t m_sq_entries = 0;
+        uint32_t m_cq_entries = 0;
+        uint32_t m_tail = 0;
+        uint32_t m_to_submit = 0;
+        size_t m_in_flight = 0;
+        char* m_slots = nullptr;
+        std::vector<int> m_free_slots;
+        std::mutex m_mutex;
+        std::vector<XENON_HF_io_request*> m_pending;
+        bool m_ready = false;
+    };
+#endif // XENON_M_IO_URING
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Checks whether async_read and async_write go through io_uring.
+         * @note   When they don't, they run read_file and write_file on the default thread pool.
+         * @retval True if io_uring is used
+         */
+        [[nodiscard]] inline bool async_uses_io_uring(void) noexcept {
+#ifdef XENON_M_IO_URING
+            return XENON_HF_io_ring::instance() != nullptr;
+#else
+            return false;
+#endif // XENON_M_IO_URING
+        }
+
+        /**
+         * @brief Reads several files without blocking.
+         * @note   All of them are submitted to the kernel at once.
+         * @param  paths: The paths for the specified files
+         * @retval A future of every file's data, in the same order. A future holds std::nullopt if its file couldn't be read
+         */
+        [[nodiscard]] inline std::vector<xenon::async::future<std::optional<std::string>>> async_read(const std::span<const std::string> paths) noexcept {
+            std::vector<xenon::async::future<std::optional<std::string>>> futures;
+            futures.reserve(paths.size());
+#ifdef XENON_M_IO_URING
+            if(XENON_HF_io_ring* const ring = XENON_HF_io_ring::instance(); ring != nullptr) [[likely]] {
+                std::vector<XENON_HF_io_request*> requests;
+                requests.reserve(paths.size());
+                for(const std::string& path : paths) {
+                    XENON_HF_io_request* const request = new XENON_HF_io_request();
+                    request->path = path;
+                    futures.push_back(request->read_done.emplace().get_future());
+                    requests.push_back(request);
+                }
+                ring->submit(requests);
+                return futures;
+            }
+#endif // XENON_M_IO_URING
+            for(const std::string& path : paths)
+                futures.push_back(xenon::async::run([path]() { return XENON_HF_read_file(path); }));
+            return futures;
+        }
+
+        /**
+         * @brief Reads a file without blocking.
+         * @note
+         * @param  path: The path for the specified file
+         * @retval A future of the file's data. Holds std::nullopt if the file couldn't be read
+         */
+        [[nodiscard]] inline xenon::async::future<std::optional<std::string>> async_read(const std::string& path) noexcept {
+            return std::move(async_read(std::span<const std::string>(&path, 1)).front());
+        }
+
+        /**
+         * @brief Reads a file without blocking and calls a function with its data.
+         * @note   The function runs on the default thread pool.
+         * @param  path: The path for the specified file
+         * @param  callback_func: A function that accepts std::optional<std::string>
+         * @retval None
+         */
+        template<typename F>
+            requires xenon::concepts::callable<F, std::optional<std::string>>
+        inline void async_read(const std::string& path, F&& callback_func) noexcept {
+            static_cast<void>(async_read(path).then(std::forward<F>(callback_func)));
+        }
+
+        /**
+         * @brief Writes a new content to a file without blocking.
+         * @note   overwrite truncates the file. Each mode creates it. atomic writes go through the thread pool, where concurrent ones share their syncs.
+         * @param  path: The path for the specified file
+         * @param  content: The content that will be written to that file
+         * @param  open_mode: Writing mode
+         * @retval A future of whether everything was written
+         */
+        [[nodiscard]] inline xenon::async::future<bool> async_write(const std::string& path, std::string content, const writing_mode open_mode = writing_mode::overwrite) noexcept {
+#ifdef XENON_M_IO_URING
+            if(XENON_HF_io_ring* const ring = XENON_HF_io_ring::instance(); ring != nullptr && open_mode != writing_mode::atomic) [[likely]] {
+                XENON_HF_io_request* const request = new XENON_HF_io_request();
+                request->writing = true;
+                request->appending = open_mode == writing_mode::append;
+                request->path = path;
+                request->data = std::move(content);
+                xenon::async::future<bool> result = request->write_done.emplace().get_future();
+                std::vector<XENON_HF_io_request*> requests(1, request);
+                ring->submit(requests);
+                return result;
+            }
+#endif // XENON_M_IO_URING
+            return xenon::async::run([path, content = std::move(content), open_mode]() { return XENON_HF_write_whole(path, content, open_mode); });
+        }
+
+        /**
+         * @brief Writes a new content to a file without blocking and calls a function with whether it worked.
+         * @note   The function runs on the default thread pool.
+         * @param  path: The path for the specified file
+         * @param  content: The content that will be written to that file
+         * @param  callback_func: A function that accepts a bool
+         * @param  open_mode: Writing mode
+         * @retval None
+         */
+        template<typename F>
+            requires xenon::concepts::callable<F, bool>
+        inline void async_write(const std::string& path, std::string content, F&& callback_func, const writing_mode open_mode = writing_mode::overwrite) noexcept {
+            static_cast<void>(async_write(path, std::move(content), open_mode).then(std::forward<F>(callback_func)));
+        }
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_ASYNC_IO
@@ -0,0 +1,327 @@
+// copy.hpp
+//
+// File copying functions that are a part of a Files module.
+
+#ifndef XENON_HG_FILES_COPY
+#define XENON_HG_FILES_COPY
+
+#include "../macros.hpp"
+
+// Libraries
+#include <string>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef XENON_M_WIN
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif // XENON_M_WIN
+
+#ifdef XENON_M_LINUX
+#include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif // XENON_M_LINUX
+
+// Xenon's Modules
+#include "../async/parallel.hpp"
+#include "../concepts/concepts.hpp"
+#include "../bench/profiler.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    struct XENON_HF_no_progress {
+        void operator()(const uint64_t, const uint64_t) const noexcept {}
+    };
+
+    // How much one call copies between two progress reports
+    inline constexpr uint64_t XENON_HF_copy_step = uint64_t(64) << 20;
+    // The buffer for copying through user space, when the kernel can't copy by itself
+    inline constexpr size_t XENON_HF_copy_buffer = size_t(1) << 20;
+
+#ifdef XENON_M_WIN
+    /**
+     * @brief Copies length bytes between two handles at the given offsets through a buffer.
+     */
+    template<typename F>
+    inline bool XENON_HF_copy_handles(const HANDLE in, const uint64_t in_offset, const HANDLE out, const uint64_t out_offset, const uint64_t length, F& progress_func) noexcept {
+        const std::unique_ptr<char[]> buffer(new(std::nothrow) char[XENON_HF_copy_buffer]);
+        if(buffer == nullptr) [[unlikely]]
+            return false;
+        for(uint64_t copied = 0; copied < length;) {
+            OVERLAPPED position = {};
+            position.Offset = static_cast<DWORD>(in_offset + copied);
+            position.OffsetHigh = static_cast<DWORD>((in_offset + copied) >> 32);
+            DWORD read = 0;
+            if(!ReadFile(in, buffer.get(), static_cast<DWORD>(std::min<uint64_t>(length - copied, XENON_HF_copy_buffer)), &read, &position)) [[unlikely]]
+                return false;
+            if(read == 0)
+                break;
+            position = {};
+            position.Offset = static_cast<DWORD>(out_offset + copied);
+            position.OffsetHigh = static_cast<DWORD>((out_offset + copied) >> 32);
+            DWORD written = 0;
+            if(!WriteFile(out, buffer.get(), read, &written, &position) || written != read) [[unlikely]]
+                return false;
+            copied += read;
+            progress_func(copied, length);
+        }
+        return true;
+    }
+#else
+    /**
+     * @brief Copies length bytes between two descriptors at the given offsets, without moving either file position.
+     * @note   copy_file_range first, which stays in the kernel and reflinks or copies server-side where the file system can.
+     *         Then sendfile, which also stays in the kernel but can't cross every pair of file systems. pread/pwrite through a buffer as the last resort.
+     *         Stops early without failing if the source gets shorter while it's copied.
+     */
+    template<typename F>
+    inline bool XENON_HF_copy_descriptors(const int in, const uint64_t in_offset, const int out, const uint64_t out_offset, const uint64_t length, F& progress_func) noexcept {
+        enum class method {
+            copy_file_range,
+            sendfile,
+            buffer
+        };
+#ifdef XENON_M_LINUX
+        method current = method::copy_file_range;
+#else
+        method current = method::buffer;
+#endif // XENON_M_LINUX
+        std::unique_ptr<char[]> buffer;
+
+        for(uint64_t copied = 0; copied < length;) {
+            const uint64_t step = std::min(length - copied, XENON_HF_copy_step);
+            ssize_t done = -1;
+#ifdef XENON_M_LINUX
+            if(current == method::copy_file_range) {
+                loff_t from = static_cast<loff_t>(in_offset + copied), to = static_cast<loff_t>(out_offset + copied);
+                done = copy_file_range(in, &from, out, &to, step, 0);
+                // Not supported by the kernel or between these two file systems
+                if(done < 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF)) {
+                    current = method::sendfile;
+                    continue;
+                }
+            } else if(current == method::sendfile) {
+                // sendfile writes at the file position of the destination
+                off_t from = static_cast<off_t>(in_offset + copied);
+                if(lseek(out, static_cast<off_t>(out_offset + copied), SEEK_SET) < 0) [[unlikely]]
+                    return false;
+                done = sendfile(out, in, &from, step);
+                if(done < 0 && (errno == EINVAL || errno == ENOSYS)) {
+                    current = method::buffer;
+                    continue;
+                }
+            } else
+#endif // XENON_M_LINUX
+            {
+                if(buffer == nullptr) {
+                    buffer.reset(new(std::nothrow) char[XENON_HF_copy_buffer]);
+                    if(buffer == nullptr) [[unlikely]]
+                        return false;
+                }
+                done = pread(in, buffer.get(), std::min<uint64_t>(step, XENON_HF_copy_buffer), static_cast<off_t>(in_offset + copied));
+                for(ssize_t written = 0; done > 0 && written < done;) {
+                    const ssize_t result = pwrite(out, buffer.get() + written, static_cast<size_t>(done - written), static_cast<off_t>(out_offset + copied + written));
+                    if(result < 0 && errno != EINTR) [[unlikely]]
+                        return false;
+                    written += result > 0 ? result : 0;
+                }
+            }
+
+            if(done < 0) [[unlikely]] {
+                if(errno == EINTR)
+                    continue;
+                return false;
+            }
+            if(done == 0)
+                break;
+            copied += static_cast<uint64_t>(done);
+            progress_func(copied, length);
+        }
+        return true;
+    }
+#endif // XENON_M_WIN
+
+    /**
+     * @brief Opens both files and copies [source_offset, source_offset + length) to destination_offset, or to the current end of the destination when appending.
+     * @note   length is clipped to the end of the source.
+     */
+    template<typename F>
+    inline bool XENON_HF_copy_range(const std::string& source, const uint64_t source_offset, const std::string& destination, uint64_t destination_offset, uint64_t length, const bool append, F& progress_func) noexcept {
+#ifdef XENON_M_WIN
+        const HANDLE in = CreateFileA(source.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(in == INVALID_HANDLE_VALUE) [[unlikely]]
+            return false;
+        const HANDLE out = CreateFileA(destination.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER source_size, destination_size;
+        if(out == INVALID_HANDLE_VALUE || !GetFileSizeEx(in, &source_size) || !GetFileSizeEx(out, &destination_size)) [[unlikely]] {
+            CloseHandle(in);
+            if(out != INVALID_HANDLE_VALUE)
+                CloseHandle(out);
+            return false;
+        }
+        const uint64_t available = static_cast<uint64_t>(source_size.QuadPart) > source_offset ? static_cast<uint64_t>(source_size.QuadPart) - source_offset : 0;
+        if(append)
+            destination_offset = static_cast<uint64_t>(destination_size.QuadPart);
+        length = std::min(length, available);
+        const bool copied = XENON_HF_copy_handles(in, source_offset, out, destination_offset, length, progress_func);
+        CloseHandle(in);
+        return CloseHandle(out) && copied;
+#else
+        const int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+        if(in < 0) [[unlikely]]
+            return false;
+        // Not O_APPEND even when appending: copy_file_range refuses descriptors opened with it
+        const int out = open(destination.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+        struct stat source_info, destination_info;
+        if(out < 0 || fstat(in, &source_info) != 0 || !S_ISREG(source_info.st_mode) || fstat(out, &destination_info) != 0) [[unlikely]] {
+            close(in);
+            if(out >= 0)
+                close(out);
+            return false;
+        }
+        const uint64_t source_size = static_cast<uint64_t>(source_info.st_size);
+        const uint64_t available = source_size > source_offset ? source_size - source_offset : 0;
+        if(append)
+            destination_offset = static_cast<uint64_t>(destination_info.st_size);
+        length = std::min(length, available);
+        const bool copied = XENON_HF_copy_descriptors(in, source_offset, out, destination_offset, length, progress_func);
+        close(in);
+        return close(out) == 0 && copied;
+#endif // XENON_M_WIN
+    }
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Copies a file, replacing the destination if it exists.
+         * @note   The data never passes through user space where the OS can help it: on Linux the destination is a reflink(FICLONE) of the source on file systems that share extents(Btrfs, XFS),
+         *         and otherwise copy_file_range or sendfile copies it inside the kernel. Windows uses CopyFileEx. Keeps the permission bits of the source.
+         * @param  source: The path for the file to copy
+         * @param  destination: The path for the copy
+         * @param  progress_func: A function that accepts copied and total bytes, called after every chunk(64MiB at most)
+         * @retval True if copied correctly
+         */
+        template<typename F = XENON_HF_no_progress>
+            requires xenon::concepts::callable<F, uint64_t, uint64_t>
+        inline bool copy(const std::string& source, const std::string& destination, F&& progress_func = F()) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::copy");
+#ifdef XENON_M_WIN
+            const LPPROGRESS_ROUTINE routine = [](LARGE_INTEGER total, LARGE_INTEGER copied, LARGE_INTEGER, LARGE_INTEGER, DWORD, DWORD, HANDLE, HANDLE, LPVOID data) -> DWORD {
+                (*static_cast<std::remove_reference_t<F>*>(data))(static_cast<uint64_t>(copied.QuadPart), static_cast<uint64_t>(total.QuadPart));
+                return PROGRESS_CONTINUE;
+            };
+            return CopyFileExA(source.c_str(), destination.c_str(), routine, const_cast<void*>(static_cast<const void*>(&progress_func)), nullptr, 0);
+#else
+            const int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+            if(in < 0) [[unlikely]]
+                return false;
+            struct stat info, existing;
+            if(fstat(in, &info) != 0 || !S_ISREG(info.st_mode) || (stat(destination.c_str(), &existing) == 0 && existing.st_dev == info.st_dev && existing.st_ino == info.st_ino)) [[unlikely]] {
+                // Truncating the destination would destroy the source if they are the same file
+                close(in);
+                return false;
+            }
+            const int out = open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & 07777);
+            if(out < 0) [[unlikely]] {
+                close(in);
+                return false;
+            }
+            const uint64_t size = static_cast<uint64_t>(info.st_size);
+            bool copied = false;
+#ifdef XENON_M_LINUX
+            if(ioctl(out, FICLONE, in) == 0) {
+                progress_func(size, size);
+                copied = true;
+            }
+#endif // XENON_M_LINUX
+            if(!copied)
+                copied = XENON_HF_copy_descriptors(in, 0, out, 0, size, progress_func);
+            close(in);
+            return close(out) == 0 && copied;
+#endif // XENON_M_WIN
+        }
+
+        /**
+         * @brief Copies a part of a file into another file at an offset, leaving the rest of the destination as it is.
+         * @note   Creates the destination if it doesn't exist. The range is clipped to the end of the source. Copies inside the kernel like copy() does.
+         * @param  source: The path for the file to copy from
+         * @param  source_offset: Where the range starts in the source
+         * @param  destination: The path for the file to copy into
+         * @param  destination_offset: Where the range goes in the destination
+         * @param  length: How many bytes to copy. The default copies up to the end of the source
+         * @param  progress_func: A function that accepts copied and total bytes
+         * @retval True if copied correctly
+         */
+        template<typename F = XENON_HF_no_progress>
+            requires xenon::concepts::callable<F, uint64_t, uint64_t>
+        inline bool copy_range(const std::string& source, const uint64_t source_offset, const std::string& destination, const uint64_t destination_offset, const uint64_t length = std::numeric_limits<uint64_t>::max(), F&& progress_func = F()) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::copy_range");
+            return XENON_HF_copy_range(source, source_offset, destination, destination_offset, length, false, progress_func);
+        }
+
+        /**
+         * @brief Appends the contents of a file to another file.
+         * @note   Creates the destination if it doesn't exist. Copies inside the kernel like copy() does.
+         *         The end of the destination is read once at the start, so appends from other writers at the same time can be overwritten.
+         * @param  source: The path for the file to append
+         * @param  destination: The path for the file to append to
+         * @param  progress_func: A function that accepts copied and total bytes
+         * @retval True if appended correctly
+         */
+        template<typename F = XENON_HF_no_progress>
+            requires xenon::concepts::callable<F, uint64_t, uint64_t>
+        inline bool append_file(const std::string& source, const std::string& destination, F&& progress_func = F()) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::append_file");
+            return XENON_HF_copy_range(source, 0, destination, 0, std::numeric_limits<uint64_t>::max(), true, progress_func);
+        }
+
+        /**
+         * @brief Copies many files at once on the pool, which is what keeps the disk busy when the files are small and each copy is mostly open and close.
+         * @note   Each pair is copied with copy(). The progress function is called with the amount of finished and all files, one call at a time.
+         * @param  pairs: Pairs of source and destination paths
+         * @param  progress_func: A function that accepts finished and total files
+         * @param  pool: The pool to copy on
+         * @retval The amount of files that were copied correctly
+         */
+        template<typename F = XENON_HF_no_progress>
+            requires xenon::concepts::callable<F, uint64_t, uint64_t>
+        inline size_t copy_files(const std::vector<std::pair<std::string, std::string>>& pairs, F&& progress_func = F(), xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::copy_files");
+            std::mutex mutex;
+            std::atomic<size_t> succeeded = 0;
+            uint64_t finished = 0;
+            xenon::async::parallel_for(size_t(0), pairs.size(), [&](const size_t i) {
+                if(copy(pairs[i].first, pairs[i].second))
+                    succeeded.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(mutex);
+                progress_func(++finished, static_cast<uint64_t>(pairs.size()));
+            }, 0, pool);
+            return succeeded.load(std::memory_order_relaxed);
+        }
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_COPY
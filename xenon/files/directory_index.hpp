@@ -0,0 +1,477 @@
+// directory_index.hpp
+//
+// A directory index class that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_DIRECTORY_INDEX
+#define XENON_HG_FILES_DIRECTORY_INDEX
+
+#include "../macros.hpp"
+
+// Libraries
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef XENON_M_LINUX
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
+#include <climits>
+#endif // XENON_M_LINUX
+
+// Other parts of the Files component
+#include "walker.hpp"
+#include "writer.hpp"
+#include "mapped_file.hpp"
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief What the index knows about an entry.
+         * @note   The inode is 0 where the platform doesn't have one.
+         */
+        struct index_entry {
+            uint64_t size = 0;
+            // Nanoseconds since the Unix epoch
+            int64_t mtime = 0;
+            uint64_t inode = 0;
+            entry_type type = entry_type::unknown;
+
+            [[nodiscard]] bool operator==(const index_entry& other) const noexcept = default;
+        };
+
+        /**
+         * @brief How an entry changed.
+         * @note
+         */
+        enum class change_kind {
+            added,
+            removed,
+            modified
+        };
+
+        /**
+         * @brief One change that the index picked up.
+         * @note   For removed entries, entry is what the index had before.
+         */
+        struct change {
+            change_kind kind;
+            std::string path;
+            index_entry entry;
+        };
+    } // namespace files
+} // namespace xenon
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    inline bool XENON_HF_stat_entry(const std::string& path, xenon::files::index_entry& entry) noexcept {
+#ifdef XENON_M_LINUX
+        struct stat info;
+        if(lstat(path.c_str(), &info) != 0)
+            return false;
+        entry.size = static_cast<uint64_t>(info.st_size);
+        entry.mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + static_cast<int64_t>(info.st_mtim.tv_nsec);
+        entry.inode = static_cast<uint64_t>(info.st_ino);
+        entry.type = S_ISREG(info.st_mode) ? xenon::files::entry_type::file : S_ISDIR(info.st_mode) ? xenon::files::entry_type::directory : S_ISLNK(info.st_mode) ? xenon::files::entry_type::symlink : xenon::files::entry_type::other;
+        return true;
+#else
+        std::error_code error;
+        const std::filesystem::file_status status = std::filesystem::symlink_status(path, error);
+        if(error || !std::filesystem::exists(status))
+            return false;
+        entry.type = std::filesystem::is_symlink(status) ? xenon::files::entry_type::symlink : std::filesystem::is_directory(status) ? xenon::files::entry_type::directory : std::filesystem::is_regular_file(status) ? xenon::files::entry_type::file : xenon::files::entry_type::other;
+        entry.size = entry.type == xenon::files::entry_type::file ? static_cast<uint64_t>(std::filesystem::file_size(path, error)) : 0;
+        const auto written = std::filesystem::last_write_time(path, error);
+        entry.mtime = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::clock_cast<std::chrono::system_clock>(written).time_since_epoch()).count());
+        entry.inode = 0;
+        return true;
+#endif // XENON_M_LINUX
+    }
+
+    /**
+     * @brief Walks a tree in parallel and stats every entry. Calls directory_func(path) for every directory on the calling thread afterwards.
+     */
+    template<typename F>
+    inline std::map<std::string, xenon::files::index_entry> XENON_HF_scan_tree(const std::string& root, F&& directory_func) noexcept {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, xenon::files::index_entry>> found;
+        xenon::files::walk(root, [&](const xenon::files::walk_entry& entry) {
+            std::pair<std::string, xenon::files::index_entry> item(std::string(entry.path), xenon::files::index_entry());
+            if(!XENON_HF_stat_entry(item.first, item.second))
+                return;
+            std::lock_guard<std::mutex> lock(mutex);
+            found.push_back(std::move(item));
+        });
+        std::sort(found.begin(), found.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+        std::map<std::string, xenon::files::index_entry> entries;
+        for(auto& item : found) {
+            if(item.second.type == xenon::files::entry_type::directory)
+                directory_func(item.first);
+            // Sorted input goes in at the end, so building the map is linear
+            entries.emplace_hint(entries.end(), std::move(item));
+        }
+        return entries;
+    }
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Keeps a snapshot of a directory tree(path, size, mtime, inode) and turns file system events into a list of changes, so the tree doesn't have to be rescanned to find out what changed.
+         * @note   Uses inotify on Linux. Elsewhere, or when inotify runs out of watches, poll() falls back to a full rescan. Not thread-safe.
+         *         The root itself isn't an entry. Events are only hints: every path they mention is stat-ed again before a change is reported, so bursts of events coalesce into one change.
+         */
+        class directory_index final {
+        public:
+            /**
+             * @brief Constructs an empty index of a directory.
+             * @note   Call build() or load() to fill it.
+             * @param  root: The path to the specified directory
+             */
+            explicit directory_index(std::string root) noexcept
+                : m_root(std::move(root)) {
+                while(m_root.size() > 1 && m_root.back() == '/')
+                    m_root.pop_back();
+            }
+
+            directory_index(const directory_index&) = delete;
+            directory_index& operator=(const directory_index&) = delete;
+
+            /**
+             * @brief Scans the whole tree and starts watching it.
+             * @note   The scan runs in parallel with walk().
+             * @retval True if the tree is being watched, false if poll() will rescan instead
+             */
+            bool build(void) noexcept {
+                stop_watching();
+                m_entries = scan();
+                return start_watching();
+            }
+
+            /**
+             * @brief Rescans the whole tree and reports what differs from the snapshot.
+             * @note   Use it after load() to pick up what changed while nothing was watching.
+             * @retval The changes
+             */
+            std::vector<change> refresh(void) noexcept {
+                stop_watching();
+                std::map<std::string, index_entry> current = scan();
+                std::vector<change> changes;
+                auto old_it = m_entries.begin();
+                auto new_it = current.begin();
+                // Both maps are sorted, so they are merged in one pass
+                while(old_it != m_entries.end() || new_it != current.end()) {
+                    if(new_it == current.end() || (old_it != m_entries.end() && old_it->first < new_it->first)) {
+                        changes.push_back({ change_kind::removed, old_it->first, old_it->second });
+                        ++old_it;
+                    } else if(old_it == m_entries.end() || new_it->first < old_it->first) {
+                        changes.push_back({ change_kind::added, new_it->first, new_it->second });
+                        ++new_it;
+                    } else {
+                        // Same as poll(): a directory's own times change with its contents, so only its contents are reported
+                        if(old_it->second.type != new_it->second.type) {
+                            changes.push_back({ change_kind::removed, old_it->first, old_it->second });
+                            changes.push_back({ change_kind::added, new_it->first, new_it->second });
+                        } else if(!(old_it->second == new_it->second) && new_it->second.type != entry_type::directory)
+                            changes.push_back({ change_kind::modified, new_it->first, new_it->second });
+                        ++old_it;
+                        ++new_it;
+                    }
+                }
+                m_entries = std::move(current);
+                start_watching();
+                return changes;
+            }
+
+            /**
+             * @brief Waits for file system events and applies them to the snapshot.
+             * @note   Falls back to refresh() when the tree isn't watched, or when the kernel dropped events.
+             * @param  timeout: How long to wait for the first event. 0 doesn't wait
+             * @retval The changes, in path order
+             */
+            std::vector<change> poll(const std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) noexcept {
+#ifdef XENON_M_LINUX
+                if(m_inotify < 0)
+                    return refresh();
+                pollfd descriptor = { m_inotify, POLLIN, 0 };
+                if(::poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0)
+                    return {};
+
+                std::set<std::string> dirty;
+                alignas(inotify_event) char buffer[64 * (sizeof(inotify_event) + NAME_MAX + 1)];
+                for(;;) {
+                    const ssize_t read = ::read(m_inotify, buffer, sizeof(buffer));
+                    if(read <= 0)
+                        break;
+                    for(ssize_t offset = 0; offset < read;) {
+                        const inotify_event* const event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                        if(event->mask & IN_Q_OVERFLOW)
+                            return refresh();
+                        const auto watch = m_watches.find(event->wd);
+                        if(watch == m_watches.end())
+                            continue;
+                        if(event->mask & IN_IGNORED) {
+                            m_watched.erase(watch->second);
+                            m_watches.erase(watch);
+                            continue;
+                        }
+                        if(event->len > 0)
+                            dirty.insert(watch->second + '/' + event->name);
+                        else if(watch->second != m_root)
+                            dirty.insert(watch->second);
+                    }
+                }
+
+                // Parents come before their children, so a removed or added subtree is handled once
+                std::vector<change> changes;
+                for(const std::string& path : dirty)
+                    reconcile(path, changes);
+                return changes;
+#else
+                static_cast<void>(timeout);
+                return refresh();
+#endif // XENON_M_LINUX
+            }
+
+            /**
+             * @brief Saves the snapshot to a file, for a fast start next time.
+             * @note   Written atomically, so a crash in the middle leaves the previous snapshot in place.
+             * @param  path: The path for the specified file
+             * @retval True if saved correctly
+             */
+            bool save(const std::string& path) const noexcept {
+                writer file(path, writing_mode::atomic);
+                const uint64_t count = m_entries.size();
+                bool good = file.write(std::string_view(magic, sizeof(magic))) && write_value(file, count);
+                for(const auto& [entry_path, entry] : m_entries) {
+                    const uint32_t length = static_cast<uint32_t>(entry_path.size());
+                    const uint8_t type = static_cast<uint8_t>(entry.type);
+                    good = good && write_value(file, length) && file.write(entry_path) && write_value(file, entry.size) && write_value(file, entry.mtime) && write_value(file, entry.inode) && write_value(file, type);
+                }
+                return file.close() && good;
+            }
+
+            /**
+             * @brief Loads a snapshot that save() wrote and starts watching the tree.
+             * @note   Doesn't look at the tree, so call refresh() to find out what changed since the snapshot was saved.
+             * @param  path: The path for the specified file
+             * @retval True if loaded correctly. The index is left empty otherwise
+             */
+            bool load(const std::string& path) noexcept {
+                stop_watching();
+                m_entries.clear();
+                const mapped_file file(path, access_hint::sequential);
+                std::string_view data = file.view();
+                uint64_t count = 0;
+                if(!data.starts_with(std::string_view(magic, sizeof(magic))))
+                    return false;
+                data.remove_prefix(sizeof(magic));
+                if(!read_value(data, count))
+                    return false;
+                for(uint64_t i = 0; i < count; ++i) {
+                    uint32_t length = 0;
+                    uint8_t type = 0;
+                    index_entry entry;
+                    if(!read_value(data, length) || data.size() < length) {
+                        m_entries.clear();
+                        return false;
+                    }
+                    std::string entry_path(data.substr(0, length));
+                    data.remove_prefix(length);
+                    if(!read_value(data, entry.size) || !read_value(data, entry.mtime) || !read_value(data, entry.inode) || !read_value(data, type)) {
+                        m_entries.clear();
+                        return false;
+                    }
+                    entry.type = static_cast<entry_type>(type);
+                    m_entries.emplace_hint(m_entries.end(), std::move(entry_path), entry);
+                }
+                start_watching();
+                return true;
+            }
+
+            /**
+             * @brief Finds an entry.
+             * @note
+             * @param  path: The root joined with the entry's relative path
+             * @retval The entry, or null if the index doesn't have it
+             */
+            [[nodiscard]] const index_entry* find(const std::string& path) const noexcept {
+                const auto it = m_entries.find(path);
+                return it != m_entries.end() ? &it->second : nullptr;
+            }
+
+            /**
+             * @brief Calls a function with every entry, in path order.
+             * @note
+             * @param  callback_func: A function that accepts const std::string& and const index_entry&
+             * @retval None
+             */
+            template<typename F>
+                requires requires(F&& func, const std::string& path, const index_entry& entry) {
+                    func(path, entry);
+                }
+            void for_each(F&& callback_func) const noexcept {
+                for(const auto& [path, entry] : m_entries)
+                    callback_func(path, entry);
+            }
+
+            /**
+             * @brief Gets the amount of entries.
+             * @note
+             * @retval Amount of entries
+             */
+            [[nodiscard]] size_t size(void) const noexcept {
+                return m_entries.size();
+            }
+
+            /**
+             * @brief Checks whether the tree is watched, so poll() doesn't have to rescan.
+             * @note
+             * @retval True if watched
+             */
+            [[nodiscard]] bool watching(void) const noexcept {
+                return m_inotify >= 0;
+            }
+
+            ~directory_index(void) noexcept {
+                stop_watching();
+            }
+        private:
+            static constexpr char magic[8] = { 'X', 'E', 'N', 'O', 'N', 'I', 'X', '1' };
+
+            template<typename T>
+            static bool write_value(writer& file, const T value) noexcept {
+                return file.write(std::string_view(reinterpret_cast<const char*>(&value), sizeof(T)));
+            }
+
+            template<typename T>
+            static bool read_value(std::string_view& data, T& value) noexcept {
+                if(data.size() < sizeof(T))
+                    return false;
+                std::memcpy(&value, data.data(), sizeof(T));
+                data.remove_prefix(sizeof(T));
+                return true;
+            }
+
+            std::map<std::string, index_entry> scan(void) noexcept {
+                return XENON_HF_scan_tree(m_root, [](const std::string&) {});
+            }
+
+#ifdef XENON_M_LINUX
+            /**
+             * @brief Watches a directory. A directory that is watched already keeps its watch, which now maps to the new path(that's how moves are followed).
+             */
+            bool watch(const std::string& path) noexcept {
+                const int watch = inotify_add_watch(m_inotify, path.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW);
+                if(watch < 0)
+                    return false;
+                if(const auto old = m_watches.find(watch); old != m_watches.end())
+                    m_watched.erase(old->second);
+                m_watches[watch] = path;
+                m_watched[path] = watch;
+                return true;
+            }
+
+            /**
+             * @brief Stops watching a directory.
+             */
+            std::map<std::string, int>::iterator unwatch(const std::map<std::string, int>::iterator watched) noexcept {
+                inotify_rm_watch(m_inotify, watched->second);
+                m_watches.erase(watched->second);
+                return m_watched.erase(watched);
+            }
+
+            /**
+             * @brief Stats a path that an event mentioned and reports how it differs from the snapshot.
+             */
+            void reconcile(const std::string& path, std::vector<change>& changes) noexcept {
+                index_entry current;
+                const bool exists = XENON_HF_stat_entry(path, current);
+                const auto known = m_entries.find(path);
+                if(known != m_entries.end() && (!exists || known->second.type != current.type)) {
+                    // Gone, or replaced by something of another type: the whole subtree goes
+                    const std::string prefix = path + '/';
+                    changes.push_back({ change_kind::removed, known->first, known->second });
+                    m_entries.erase(known);
+                    // Siblings like "src.bak" sort between "src" and "src/", so the subtree starts at the prefix rather than right after the entry
+                    for(auto it = m_entries.lower_bound(prefix); it != m_entries.end() && it->first.starts_with(prefix); it = m_entries.erase(it))
+                        changes.push_back({ change_kind::removed, it->first, it->second });
+                    if(const auto watched = m_watched.find(path); watched != m_watched.end())
+                        unwatch(watched);
+                    for(auto watched = m_watched.lower_bound(prefix); watched != m_watched.end() && watched->first.starts_with(prefix);)
+                        watched = unwatch(watched);
+                }
+                if(!exists)
+                    return;
+                if(const auto it = m_entries.find(path); it == m_entries.end()) {
+                    changes.push_back({ change_kind::added, path, current });
+                    m_entries.emplace(path, current);
+                    if(current.type == entry_type::directory) {
+                        // Watching first and scanning second, so nothing created in between is missed
+                        watch(path);
+                        std::map<std::string, index_entry> subtree = XENON_HF_scan_tree(path, [this](const std::string& directory) { watch(directory); });
+                        for(auto& item : subtree) {
+                            if(const auto [inserted, added] = m_entries.insert(std::move(item)); added)
+                                changes.push_back({ change_kind::added, inserted->first, inserted->second });
+                        }
+                    }
+                } else if(!(it->second == current) && current.type != entry_type::directory) {
+                    it->second = current;
+                    changes.push_back({ change_kind::modified, path, current });
+                } else
+                    it->second = current;
+            }
+#endif // XENON_M_LINUX
+
+            bool start_watching(void) noexcept {
+#ifdef XENON_M_LINUX
+                m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                if(m_inotify < 0)
+                    return false;
+                bool watched = watch(m_root);
+                for(const auto& [path, entry] : m_entries)
+                    if(watched && entry.type == entry_type::directory)
+                        watched = watch(path);
+                // Out of watches(fs.inotify.max_user_watches): a partly watched tree would miss changes, so poll() rescans instead
+                if(!watched)
+                    stop_watching();
+                return watched;
+#else
+                return false;
+#endif // XENON_M_LINUX
+            }
+
+            void stop_watching(void) noexcept {
+#ifdef XENON_M_LINUX
+                if(m_inotify >= 0)
+                    ::close(m_inotify);
+                m_inotify = -1;
+                m_watches.clear();
+                m_watched.clear();
+#endif // XENON_M_LINUX
+            }
+
+            std::string m_root;
+            std::map<std::string, index_entry> m_entries;
+            int m_inotify = -1;
+            std::unordered_map<int, std::string> m_watches;
+            std::map<std::string, int> m_watched;
+        };
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_DIRECTORY_INDEX
@@ -11,105 +11,161 @@
 #include <optional>
 #include <vector>
 #include <filesystem>
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <mutex>
+#include <cstring>
+#include <cstdint>
+
+// Other parts of the Files component
+#include "mapped_file.hpp"
+#include "newlines.hpp"
+#include "lines.hpp"
+#include "writer.hpp"
+#include "async_io.hpp"
+#include "walker.hpp"
+#include "directory_index.hpp"
+#include "copy.hpp"
+#include "hash.hpp"
+
+// Xenon's Modules
+#include "../bench/profiler.hpp"
 
 namespace fs = std::filesystem;
 
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    /**
+     * @brief Adds a line that ended with '\n'. On Windows a '\r' before the newline goes too, like the text mode streams drop it.
+     */
+    inline void XENON_HF_add_line(std::vector<std::string>& lines, std::string_view line) noexcept {
+#ifdef XENON_M_WIN
+        if(!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+#endif // XENON_M_WIN
+        lines.emplace_back(line);
+    }
+
+    /**
+     * @brief Splits text on '\n' the way std::getline does and returns what's left after the last newline, so the next piece can finish it.
+     */
+    inline std::string_view XENON_HF_split_lines(std::string_view text, std::vector<std::string>& lines) noexcept {
+        for(const char* newline; (newline = static_cast<const char*>(std::memchr(text.data(), '\n', text.size()))) != nullptr;) {
+            const size_t length = static_cast<size_t>(newline - text.data());
+            XENON_HF_add_line(lines, text.substr(0, length));
+            text.remove_prefix(length + 1);
+        }
+        return text;
+    }
+}
+
 namespace xenon {
     namespace files {
-        /**
-         * @brief Writing mode that can be used when writing to files.  
-         * @note   
-         */
-        enum class writing_mode {
-            overwrite = std::ios_base::in | std::ios_base::out,
-            append = std::ios_base::app
-        };
-
         /**
          * @brief Reads the file and returns a string, containing all the file's data.
-         * @note   
+         * @note   The string is sized from the file and read into with as few system calls as possible. Newlines are kept.
+         *         A file that is truncated meanwhile(log rotation with copytruncate) gives what was left of it.
          * @param  path: The path for the specified file 
          * @retval A string, which contains all the file's data
          */
-        [[nodiscard]] std::optional<std::string> read_file(const std::string& path) noexcept {
-            if(std::ifstream file(path); file.good() && file.is_open()) [[likely]] {
-                std::string text;
-                for(std::string line; std::getline(file, line);)
-                    text += line;
-                file.close();
-                return text;
-            } else [[unlikely]]
-                return std::nullopt;
+        [[nodiscard]] inline std::optional<std::string> read_file(const std::string& path) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::read_file");
+            return XENON_HF_read_file(path);
         }
 
         /**
          * @brief Reads the file line by line and returns a vector, which contains all the lines.
-         * @note   
+         * @note   The file is read in blocks of a few megabytes, and every line is copied once out of them. On Windows "\r\n" ends a line like '\n' does.
          * @param  path: The path for the specified file
          * @param  estimated_lines_quantity: An approximated amount of lines that a file has
          * @retval All the lines of the file.
          */
-        [[nodiscard]] std::optional<std::vector<std::string>> read_file_lines(const std::string& path, const uint64_t estimated_lines_quantity = -1) noexcept {
-            if(std::ifstream file(path); file.good() && file.is_open()) [[likely]] {
-                std::vector<std::string> lines = {};
-                if(estimated_lines_quantity != static_cast<uint64_t>(-1)) [[unlikely]]
-                    lines.reserve(estimated_lines_quantity);  
-                for(std::string line; std::getline(file, line);)
-                    lines.emplace_back(line);
-                file.close();
-                return lines;
-            } else [[unlikely]]
+        [[nodiscard]] inline std::optional<std::vector<std::string>> read_file_lines(const std::string& path, const uint64_t estimated_lines_quantity = -1) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::read_file_lines");
+            std::vector<std::string> lines = {};
+            if(estimated_lines_quantity != static_cast<uint64_t>(-1)) [[unlikely]]
+                lines.reserve(estimated_lines_quantity);
+            XENON_HF_file_reader file(path);
+            if(!file.is_open()) [[unlikely]]
+                return std::nullopt;
+            std::string unfinished;
+            const bool read = XENON_HF_read_pieces(file, size_t(4) << 20, [&](const char* data, const size_t size, const bool last) {
+                std::string_view text(data, size);
+                if(!unfinished.empty()) {
+                    // The line that the piece before left unfinished
+                    const size_t newline = text.find('\n');
+                    unfinished.append(text.substr(0, newline));
+                    if(newline == std::string_view::npos)
+                        text = {};
+                    else {
+                        XENON_HF_add_line(lines, unfinished);
+                        unfinished.clear();
+                        text.remove_prefix(newline + 1);
+                    }
+                }
+                unfinished.append(XENON_HF_split_lines(text, lines));
+                // The last line has no newline after it
+                if(last && !unfinished.empty())
+                    lines.emplace_back(std::move(unfinished));
+            });
+            if(!read) [[unlikely]]
                 return std::nullopt;
+            return lines;
         }
 
         /**
          * @brief Counts the number of lines in a file.
-         * @note   
+         * @note   Reads the file in blocks of parallel_count_threshold bytes and counts each with count_newlines, so big files are counted with SIMD on several threads.
          * @param  path: The path for the specified file  
          * @retval Number of lines
          */
-        [[nodiscard]] std::optional<uint64_t> count_lines(const std::string& path) noexcept {
-            if(std::ifstream file(path); file.good() && file.is_open()) [[likely]] {
-                file.unsetf(std::ios_base::skipws);
-                const uint64_t lines = static_cast<uint64_t>(std::count(std::istream_iterator<char>(file), std::istream_iterator<char>(), '\n')); 
-                file.close();
-                return lines;
-            }
-            else [[unlikely]]
+        [[nodiscard]] inline std::optional<uint64_t> count_lines(const std::string& path) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::count_lines");
+            XENON_HF_file_reader file(path);
+            if(!file.is_open()) [[unlikely]]
                 return std::nullopt;
+            uint64_t count = 0;
+            const bool read = XENON_HF_read_pieces(file, parallel_count_threshold, [&count](const char* data, const size_t size, const bool) {
+                count += count_newlines(std::string_view(data, size));
+            });
+            if(!read) [[unlikely]]
+                return std::nullopt;
+            return count;
         }
 
         /**
          * @brief Writes a new content to the specified file. 
-         * @note   
+         * @note   overwrite truncates the file, atomic replaces it in one rename after syncing, so a crash never leaves half of it. Each mode creates it. The content goes out in one system call without being copied.
          * @param  path: The path for the specified file
          * @param  content: The content that will be written to that file
          * @retval Status of the opened file. True if opened correctly. 
          */
-        bool write_file(const std::string& path, const std::string& content, const writing_mode open_mode = writing_mode::overwrite) noexcept {
-            if(std::ofstream file(path, static_cast<std::ios_base::openmode>(open_mode)); file.good() && file.is_open()) [[likely]] {
-                file << content;
-                file.close();
-                return true;
-            } else [[unlikely]]
-                return false;
+        inline bool write_file(const std::string& path, const std::string& content, const writing_mode open_mode = writing_mode::overwrite) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::write_file");
+            // The smallest buffer, so the content skips it and goes straight to the file
+            writer file(path, open_mode, durability::none, writer::direct_alignment);
+            return file.write(content) && file.close();
         }
 
         /**
          * @brief Writes a new content line by line from content vector to the specified file.
-         * @note   
+         * @note   overwrite truncates the file, atomic replaces it in one rename after syncing. Each mode creates it. The lines and newlines are gathered into writev calls without being copied.
          * @param  path: The path for the specified file
          * @param  content: The content that will be written to that file
          * @retval Status of the opened file. True if opened correctly. 
          */
-        bool write_file(const std::string& path, const std::vector<std::string>& content, const writing_mode open_mode = writing_mode::overwrite) noexcept {
-            if(std::ofstream file(path, static_cast<std::ios_base::openmode>(open_mode)); file.good() && file.is_open()) [[likely]] {
-                for(const std::string& line : content)
-                    file << line << "\n";
-                file.close();
-                return true;
-            } else [[unlikely]]
-                return false;
+        inline bool write_file(const std::string& path, const std::vector<std::string>& content, const writing_mode open_mode = writing_mode::overwrite) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::write_file");
+            writer file(path, open_mode, durability::none, writer::direct_alignment);
+            std::vector<std::string_view> pieces;
+            pieces.reserve(content.size() * 2);
+            for(const std::string& line : content) {
+                pieces.emplace_back(line);
+                pieces.emplace_back("\n");
+            }
+            return file.write(std::span<const std::string_view>(pieces)) && file.close();
         }
 
         /**
@@ -128,7 +184,7 @@ namespace xenon {
 
         /**
          * @brief Iterates a directory and calls a function with each path.
-         * @note   
+         * @note   Reads the directory with getdents64 on Linux. A directory that can't be read has no entries.
          * @param  path: The path to the specified directory.
          * @param  callback_func: A function that will be called with each path.
          * @retval None
@@ -138,13 +194,21 @@ namespace xenon {
                 func(str);
             }
         inline void iterate_folder(const std::string& path, F&& callback_func) noexcept {
-            for(const auto& dir : fs::directory_iterator(path))
-                callback_func(dir.path().string());
+            std::string entry_path = path;
+            if(!entry_path.empty() && entry_path.back() != '/')
+                entry_path += '/';
+            const size_t prefix = entry_path.size();
+            XENON_HF_list_directory(path, [&](const std::string_view name, const entry_type) {
+                entry_path.resize(prefix);
+                entry_path += name;
+                callback_func(entry_path);
+            });
         }
 
         /**
          * @brief Recursively iterates a directory and calls a function with each path.
-         * @note   
+         * @note   Directories are read in parallel with walk(), so the function runs on pool threads as well as the calling one, but one path at a time under a lock.
+         *         Don't rely on thread_local state in it, and don't wait in it for work on the same pool. Use walk() directly to skip the copy into a string and the lock.
          * @param  path: The path to the specified directory.
          * @param  callback_func: A function that will be called with each path.
          * @retval None
@@ -154,8 +218,13 @@ namespace xenon {
                 func(str);
             }
         inline void recursive_iterate_folder(const std::string& path, F&& callback_func) noexcept {
-            for(const auto& dir : fs::recursive_directory_iterator(path))
-                callback_func(dir.path().string());
+            std::mutex mutex;
+            std::string entry_path;
+            walk(path, [&](const walk_entry& entry) {
+                std::lock_guard<std::mutex> lock(mutex);
+                entry_path.assign(entry.path);
+                callback_func(entry_path);
+            });
         }
     } // namespace files
 } // namespace xenon
@@ -0,0 +1,880 @@
+// hash.hpp
+//
+// File hashing that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_HASH
+#define XENON_HG_FILES_HASH
+
+// Libraries
+#include <span>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <mutex>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// Xenon's Modules
+#include "../macros.hpp"
+#include "../utilities/parts/cpu.hpp"
+#include "../async/parallel.hpp"
+#include "../bench/profiler.hpp"
+
+#ifdef XENON_M_X86
+#include <immintrin.h>
+#endif // XENON_M_X86
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif // defined(_MSC_VER) && !defined(__clang__)
+
+// Other parts of the Files component
+#include "mapped_file.hpp"
+#include "walker.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    inline uint64_t XENON_HF_read64(const uint8_t* data) noexcept {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t XENON_HF_read32(const uint8_t* data) noexcept {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    // CRC32C
+
+    inline constexpr uint32_t XENON_HF_crc32c_polynomial = 0x82F63B78;
+
+    struct XENON_HF_crc32c_tables {
+        // table[k][n] is the CRC of byte n followed by k zero bytes, which is what slicing-by-8 needs
+        uint32_t table[8][256];
+    };
+
+    inline constexpr XENON_HF_crc32c_tables XENON_HF_crc32c_make_tables(void) noexcept {
+        XENON_HF_crc32c_tables tables = {};
+        for(uint32_t n = 0; n < 256; ++n) {
+            uint32_t crc = n;
+            for(int bit = 0; bit < 8; ++bit)
+                crc = crc & 1 ? (crc >> 1) ^ XENON_HF_crc32c_polynomial : crc >> 1;
+            tables.table[0][n] = crc;
+        }
+        for(int k = 1; k < 8; ++k)
+            for(uint32_t n = 0; n < 256; ++n)
+                tables.table[k][n] = (tables.table[k - 1][n] >> 8) ^ tables.table[0][tables.table[k - 1][n] & 0xFF];
+        return tables;
+    }
+
+    inline constexpr XENON_HF_crc32c_tables XENON_HF_crc32c_table = XENON_HF_crc32c_make_tables();
+
+    /**
+     * @brief a * b modulo the polynomial, both in the reflected bit order the CRC uses(x^0 is the top bit).
+     */
+    inline constexpr uint32_t XENON_HF_crc32c_multiply(const uint32_t a, uint32_t b) noexcept {
+        uint32_t product = 0;
+        for(uint32_t bit = uint32_t(1) << 31; bit != 0; bit >>= 1) {
+            if(a & bit)
+                product ^= b;
+            b = b & 1 ? (b >> 1) ^ XENON_HF_crc32c_polynomial : b >> 1;
+        }
+        return product;
+    }
+
+    /**
+     * @brief x^(8 * bytes) modulo the polynomial. Multiplying a CRC by it is the same as feeding it that many zero bytes.
+     */
+    inline constexpr uint32_t XENON_HF_crc32c_shift(uint64_t bytes) noexcept {
+        uint32_t result = uint32_t(1) << 31, power = uint32_t(1) << 23;
+        for(; bytes != 0; bytes >>= 1) {
+            if(bytes & 1)
+                result = XENON_HF_crc32c_multiply(result, power);
+            power = XENON_HF_crc32c_multiply(power, power);
+        }
+        return result;
+    }
+
+    /**
+     * @brief The CRC of A followed by B, from the CRCs of A and B. Works on finished CRCs, because the initial value and the final xor cancel out.
+     */
+    inline uint32_t XENON_HF_crc32c_combine(const uint32_t first, const uint32_t second, const uint64_t second_size) noexcept {
+        return XENON_HF_crc32c_multiply(XENON_HF_crc32c_shift(second_size), first) ^ second;
+    }
+
+    /**
+     * @brief Slicing-by-8. Updates the raw register: no initial value and no final xor.
+     */
+    inline uint32_t XENON_HF_crc32c_scalar(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+        const auto& table = XENON_HF_crc32c_table.table;
+        for(; size >= 8; data += 8, size -= 8) {
+            const uint64_t word = XENON_HF_read64(data) ^ crc;
+            crc = table[7][word & 0xFF] ^ table[6][(word >> 8) & 0xFF] ^ table[5][(word >> 16) & 0xFF] ^ table[4][(word >> 24) & 0xFF] ^ table[3][(word >> 32) & 0xFF] ^ table[2][(word >> 40) & 0xFF] ^ table[1][(word >> 48) & 0xFF] ^ table[0][word >> 56];
+        }
+        for(; size > 0; ++data, --size)
+            crc = table[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+        return crc;
+    }
+
+#if defined(_M_X64) || defined(__x86_64__)
+    /**
+     * @brief crc32 has a latency of 3 cycles and a throughput of 1, so three independent streams keep it busy. They are joined by shifting with a precomputed constant.
+     */
+    XENON_M_TARGET("sse4.2") inline uint32_t XENON_HF_crc32c_sse42(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+        constexpr size_t stream = 4096;
+        constexpr uint32_t shift = XENON_HF_crc32c_shift(stream);
+        for(; size >= 3 * stream; data += 3 * stream, size -= 3 * stream) {
+            uint64_t first = crc, second = 0, third = 0;
+            for(size_t i = 0; i < stream; i += 8) {
+                first = _mm_crc32_u64(first, XENON_HF_read64(data + i));
+                second = _mm_crc32_u64(second, XENON_HF_read64(data + stream + i));
+                third = _mm_crc32_u64(third, XENON_HF_read64(data + 2 * stream + i));
+            }
+            crc = XENON_HF_crc32c_multiply(shift, XENON_HF_crc32c_multiply(shift, static_cast<uint32_t>(first)) ^ static_cast<uint32_t>(second)) ^ static_cast<uint32_t>(third);
+        }
+        uint64_t value = crc;
+        for(; size >= 8; data += 8, size -= 8)
+            value = _mm_crc32_u64(value, XENON_HF_read64(data));
+        for(; size > 0; ++data, --size)
+            value = _mm_crc32_u8(static_cast<uint32_t>(value), *data);
+        return static_cast<uint32_t>(value);
+    }
+#endif // defined(_M_X64) || defined(__x86_64__)
+
+    /**
+     * @brief A finished CRC32C of a buffer.
+     */
+    inline uint32_t XENON_HF_crc32c(const uint8_t* data, const size_t size) noexcept {
+#if defined(_M_X64) || defined(__x86_64__)
+        static const bool sse42 = xenon::utilities::cpu().sse42;
+        if(sse42) [[likely]]
+            return ~XENON_HF_crc32c_sse42(~uint32_t(0), data, size);
+#endif // defined(_M_X64) || defined(__x86_64__)
+        return ~XENON_HF_crc32c_scalar(~uint32_t(0), data, size);
+    }
+
+    // XXH3
+
+    inline constexpr uint64_t XENON_HF_xxh_prime32_1 = 0x9E3779B1, XENON_HF_xxh_prime32_2 = 0x85EBCA77, XENON_HF_xxh_prime32_3 = 0xC2B2AE3D;
+    inline constexpr uint64_t XENON_HF_xxh_prime64_1 = 0x9E3779B185EBCA87, XENON_HF_xxh_prime64_2 = 0xC2B2AE3D27D4EB4F, XENON_HF_xxh_prime64_3 = 0x165667B19E3779F9, XENON_HF_xxh_prime64_4 = 0x85EBCA77C2B2AE63, XENON_HF_xxh_prime64_5 = 0x27D4EB2F165667C5;
+    inline constexpr uint64_t XENON_HF_xxh_prime_mx1 = 0x165667919E3779F9, XENON_HF_xxh_prime_mx2 = 0x9FB21C651E98DF25;
+
+    // The default secret of XXH3
+    alignas(64) inline constexpr uint8_t XENON_HF_xxh3_secret[192] = {
+        0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+        0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+        0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+        0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+        0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+        0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+        0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+        0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+        0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+        0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+        0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+        0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+    };
+
+    inline uint64_t XENON_HF_mul128_fold64(const uint64_t a, const uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+        __extension__ using uint128_t = unsigned __int128;
+        const uint128_t product = static_cast<uint128_t>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high;
+        const uint64_t low = _umul128(a, b, &high);
+        return low ^ high;
+#else
+        const uint64_t low_low = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF), high_low = (a >> 32) * (b & 0xFFFFFFFF), low_high = (a & 0xFFFFFFFF) * (b >> 32), high_high = (a >> 32) * (b >> 32);
+        const uint64_t cross = (low_low >> 32) + (high_low & 0xFFFFFFFF) + low_high;
+        return ((cross << 32) | (low_low & 0xFFFFFFFF)) ^ (high_high + (high_low >> 32) + (cross >> 32));
+#endif // defined(__SIZEOF_INT128__)
+    }
+
+    inline uint64_t XENON_HF_xxh64_avalanche(uint64_t hash) noexcept {
+        hash ^= hash >> 33;
+        hash *= XENON_HF_xxh_prime64_2;
+        hash ^= hash >> 29;
+        hash *= XENON_HF_xxh_prime64_3;
+        return hash ^ (hash >> 32);
+    }
+
+    inline uint64_t XENON_HF_xxh3_avalanche(uint64_t hash) noexcept {
+        hash ^= hash >> 37;
+        hash *= XENON_HF_xxh_prime_mx1;
+        return hash ^ (hash >> 32);
+    }
+
+    inline uint64_t XENON_HF_xxh3_mix16(const uint8_t* data, const uint8_t* secret) noexcept {
+        return XENON_HF_mul128_fold64(XENON_HF_read64(data) ^ XENON_HF_read64(secret), XENON_HF_read64(data + 8) ^ XENON_HF_read64(secret + 8));
+    }
+
+    /**
+     * @brief XXH3 of up to 240 bytes, with the default secret and a seed of 0.
+     */
+    inline uint64_t XENON_HF_xxh3_short(const uint8_t* data, const size_t size) noexcept {
+        const uint8_t* const secret = XENON_HF_xxh3_secret;
+        if(size == 0)
+            return XENON_HF_xxh64_avalanche(XENON_HF_read64(secret + 56) ^ XENON_HF_read64(secret + 64));
+        if(size <= 3) {
+            const uint32_t combined = (uint32_t(data[0]) << 16) | (uint32_t(data[size >> 1]) << 24) | uint32_t(data[size - 1]) | (uint32_t(size) << 8);
+            return XENON_HF_xxh64_avalanche(uint64_t(combined) ^ (XENON_HF_read32(secret) ^ XENON_HF_read32(secret + 4)));
+        }
+        if(size <= 8) {
+            const uint64_t keyed = (XENON_HF_read32(data + size - 4) + (uint64_t(XENON_HF_read32(data)) << 32)) ^ (XENON_HF_read64(secret + 8) ^ XENON_HF_read64(secret + 16));
+            uint64_t hash = keyed ^ std::rotl(keyed, 49) ^ std::rotl(keyed, 24);
+            hash *= XENON_HF_xxh_prime_mx2;
+            hash ^= (hash >> 35) + size;
+            hash *= XENON_HF_xxh_prime_mx2;
+            return hash ^ (hash >> 28);
+        }
+        if(size <= 16) {
+            const uint64_t low = XENON_HF_read64(data) ^ (XENON_HF_read64(secret + 24) ^ XENON_HF_read64(secret + 32));
+            const uint64_t high = XENON_HF_read64(data + size - 8) ^ (XENON_HF_read64(secret + 40) ^ XENON_HF_read64(secret + 48));
+            const uint64_t swapped = ((low & 0xFF) << 56) | ((low & 0xFF00) << 40) | ((low & 0xFF0000) << 24) | ((low & 0xFF000000) << 8) | ((low >> 8) & 0xFF000000) | ((low >> 24) & 0xFF0000) | ((low >> 40) & 0xFF00) | (low >> 56);
+            return XENON_HF_xxh3_avalanche(size + swapped + high + XENON_HF_mul128_fold64(low, high));
+        }
+        uint64_t hash = size * XENON_HF_xxh_prime64_1;
+        if(size <= 128) {
+            // Pairs of 16 bytes from both ends, moving inwards
+            for(size_t i = 0; i < 4 && size > 32 * i; ++i) {
+                hash += XENON_HF_xxh3_mix16(data + 16 * i, secret + 32 * i);
+                hash += XENON_HF_xxh3_mix16(data + size - 16 * (i + 1), secret + 32 * i + 16);
+            }
+            return XENON_HF_xxh3_avalanche(hash);
+        }
+        for(size_t i = 0; i < 8; ++i)
+            hash += XENON_HF_xxh3_mix16(data + 16 * i, secret + 16 * i);
+        hash = XENON_HF_xxh3_avalanche(hash);
+        uint64_t tail = XENON_HF_xxh3_mix16(data + size - 16, secret + 136 - 17);
+        for(size_t i = 8; i < size / 16; ++i)
+            tail += XENON_HF_xxh3_mix16(data + 16 * i, secret + 16 * (i - 8) + 3);
+        return XENON_HF_xxh3_avalanche(hash + tail);
+    }
+
+    inline void XENON_HF_xxh3_accumulate_scalar(uint64_t* accumulators, const uint8_t* data, const uint8_t* secret, const size_t stripes) noexcept {
+        for(size_t stripe = 0; stripe < stripes; ++stripe)
+            for(size_t i = 0; i < 8; ++i) {
+                const uint64_t value = XENON_HF_read64(data + 64 * stripe + 8 * i);
+                const uint64_t keyed = value ^ XENON_HF_read64(secret + 8 * stripe + 8 * i);
+                accumulators[i ^ 1] += value;
+                accumulators[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+            }
+    }
+
+    inline void XENON_HF_xxh3_scramble_scalar(uint64_t* accumulators, const uint8_t* secret) noexcept {
+        for(size_t i = 0; i < 8; ++i)
+            accumulators[i] = (accumulators[i] ^ (accumulators[i] >> 47) ^ XENON_HF_read64(secret + 8 * i)) * XENON_HF_xxh_prime32_1;
+    }
+
+#ifdef XENON_M_X86
+    XENON_M_TARGET("sse2") inline void XENON_HF_xxh3_accumulate_sse2(uint64_t* accumulators, const uint8_t* data, const uint8_t* secret, const size_t stripes) noexcept {
+        __m128i lanes[4];
+        for(size_t i = 0; i < 4; ++i)
+            lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulators) + i);
+        for(size_t stripe = 0; stripe < stripes; ++stripe)
+            for(size_t i = 0; i < 4; ++i) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 64 * stripe) + i);
+                const __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret + 8 * stripe) + i));
+                // acc[i ^ 1] += value, acc[i] += low(keyed) * high(keyed)
+                lanes[i] = _mm_add_epi64(lanes[i], _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2)));
+                lanes[i] = _mm_add_epi64(lanes[i], _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32)));
+            }
+        for(size_t i = 0; i < 4; ++i)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulators) + i, lanes[i]);
+    }
+
+    XENON_M_TARGET("sse2") inline void XENON_HF_xxh3_scramble_sse2(uint64_t* accumulators, const uint8_t* secret) noexcept {
+        const __m128i prime = _mm_set1_epi32(static_cast<int>(XENON_HF_xxh_prime32_1));
+        for(size_t i = 0; i < 4; ++i) {
+            __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulators) + i);
+            lane = _mm_xor_si128(_mm_xor_si128(lane, _mm_srli_epi64(lane, 47)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+            // A 64 bit multiply by a 32 bit prime out of two 32 bit ones
+            const __m128i high = _mm_mul_epu32(_mm_shuffle_epi32(lane, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(accumulators) + i, _mm_add_epi64(_mm_mul_epu32(lane, prime), _mm_slli_epi64(high, 32)));
+        }
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_xxh3_accumulate_avx2(uint64_t* accumulators, const uint8_t* data, const uint8_t* secret, const size_t stripes) noexcept {
+        __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators)), second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators + 4));
+        for(size_t stripe = 0; stripe < stripes; ++stripe) {
+            const __m256i* const values = reinterpret_cast<const __m256i*>(data + 64 * stripe);
+            const __m256i* const keys = reinterpret_cast<const __m256i*>(secret + 8 * stripe);
+            const __m256i value_first = _mm256_loadu_si256(values), value_second = _mm256_loadu_si256(values + 1);
+            const __m256i keyed_first = _mm256_xor_si256(value_first, _mm256_loadu_si256(keys)), keyed_second = _mm256_xor_si256(value_second, _mm256_loadu_si256(keys + 1));
+            first = _mm256_add_epi64(_mm256_add_epi64(first, _mm256_shuffle_epi32(value_first, _MM_SHUFFLE(1, 0, 3, 2))), _mm256_mul_epu32(keyed_first, _mm256_srli_epi64(keyed_first, 32)));
+            second = _mm256_add_epi64(_mm256_add_epi64(second, _mm256_shuffle_epi32(value_second, _MM_SHUFFLE(1, 0, 3, 2))), _mm256_mul_epu32(keyed_second, _mm256_srli_epi64(keyed_second, 32)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators), first);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators + 4), second);
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_xxh3_scramble_avx2(uint64_t* accumulators, const uint8_t* secret) noexcept {
+        const __m256i prime = _mm256_set1_epi32(static_cast<int>(XENON_HF_xxh_prime32_1));
+        for(size_t i = 0; i < 2; ++i) {
+            __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulators) + i);
+            lane = _mm256_xor_si256(_mm256_xor_si256(lane, _mm256_srli_epi64(lane, 47)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+            const __m256i high = _mm256_mul_epu32(_mm256_shuffle_epi32(lane, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(accumulators) + i, _mm256_add_epi64(_mm256_mul_epu32(lane, prime), _mm256_slli_epi64(high, 32)));
+        }
+    }
+#endif // XENON_M_X86
+
+    // Bytes of input between two scrambles
+    inline constexpr size_t XENON_HF_xxh3_block = 64 * ((sizeof(XENON_HF_xxh3_secret) - 64) / 8);
+
+    struct XENON_HF_xxh3_state {
+        alignas(32) uint64_t accumulators[8] = { XENON_HF_xxh_prime32_3, XENON_HF_xxh_prime64_1, XENON_HF_xxh_prime64_2, XENON_HF_xxh_prime64_3, XENON_HF_xxh_prime64_4, XENON_HF_xxh_prime32_2, XENON_HF_xxh_prime64_5, XENON_HF_xxh_prime32_1 };
+    };
+
+    /**
+     * @brief Runs whole 1KiB blocks through the accumulators: 8 accumulators over 64 byte stripes, scrambled after every block.
+     * @note   The kernels take a whole block at a time, so they are called once per kilobyte and never need to be inlined here.
+     */
+    template<typename A, typename S>
+    inline void XENON_HF_xxh3_blocks(XENON_HF_xxh3_state& state, const uint8_t* data, const size_t blocks, A&& accumulate, S&& scramble) noexcept {
+        for(size_t i = 0; i < blocks; ++i) {
+            accumulate(state.accumulators, data + i * XENON_HF_xxh3_block, XENON_HF_xxh3_secret, XENON_HF_xxh3_block / 64);
+            scramble(state.accumulators, XENON_HF_xxh3_secret + sizeof(XENON_HF_xxh3_secret) - 64);
+        }
+    }
+
+    /**
+     * @brief Finishes XXH3 of more than 240 bytes from the last part of the input, the one that holds its final block.
+     * @note   The last stripe always ends at the end of the input, even if it overlaps the one before. When the last part is shorter than a stripe, previous holds the 64 bytes before it.
+     */
+    template<typename A, typename S>
+    inline uint64_t XENON_HF_xxh3_finish(XENON_HF_xxh3_state& state, const uint8_t* data, const size_t size, const uint8_t* previous, const uint64_t total, A&& accumulate, S&& scramble) noexcept {
+        const uint8_t* const secret = XENON_HF_xxh3_secret;
+        const size_t blocks = (size - 1) / XENON_HF_xxh3_block;
+        XENON_HF_xxh3_blocks(state, data, blocks, accumulate, scramble);
+        accumulate(state.accumulators, data + blocks * XENON_HF_xxh3_block, secret, ((size - 1) - blocks * XENON_HF_xxh3_block) / 64);
+        uint8_t joined[128];
+        const uint8_t* last_stripe = data + size - 64;
+        if(size < 64) {
+            std::memcpy(joined, previous, 64);
+            std::memcpy(joined + 64, data, size);
+            last_stripe = joined + size;
+        }
+        accumulate(state.accumulators, last_stripe, secret + sizeof(XENON_HF_xxh3_secret) - 64 - 7, 1);
+
+        uint64_t hash = total * XENON_HF_xxh_prime64_1;
+        for(size_t i = 0; i < 4; ++i)
+            hash += XENON_HF_mul128_fold64(state.accumulators[2 * i] ^ XENON_HF_read64(secret + 11 + 16 * i), state.accumulators[2 * i + 1] ^ XENON_HF_read64(secret + 11 + 16 * i + 8));
+        return XENON_HF_xxh3_avalanche(hash);
+    }
+
+    /**
+     * @brief Calls func(accumulate, scramble) with the fastest kernels the CPU has.
+     */
+    template<typename F>
+    inline decltype(auto) XENON_HF_xxh3_kernels(F&& func) noexcept {
+#ifdef XENON_M_X86
+        static const bool avx2 = xenon::utilities::cpu().avx2;
+        if(avx2)
+            return func(XENON_HF_xxh3_accumulate_avx2, XENON_HF_xxh3_scramble_avx2);
+        return func(XENON_HF_xxh3_accumulate_sse2, XENON_HF_xxh3_scramble_sse2);
+#else
+        return func(XENON_HF_xxh3_accumulate_scalar, XENON_HF_xxh3_scramble_scalar);
+#endif // XENON_M_X86
+    }
+
+    inline uint64_t XENON_HF_xxh3(const uint8_t* data, const size_t size) noexcept {
+        if(size <= 240)
+            return XENON_HF_xxh3_short(data, size);
+        return XENON_HF_xxh3_kernels([&](auto&& accumulate, auto&& scramble) {
+            XENON_HF_xxh3_state state;
+            // The input is longer than a stripe, so there's nothing before it to look back at
+            return XENON_HF_xxh3_finish(state, data, size, data, size, accumulate, scramble);
+        });
+    }
+
+    // XXH3 and CRC32C digests are printed most significant byte first
+
+    inline void XENON_HF_store_big_endian(uint8_t* out, const uint64_t value, const size_t bytes) noexcept {
+        for(size_t i = 0; i < bytes; ++i)
+            out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+    }
+
+    /**
+     * @brief XXH3 of a file read in pieces of block bytes, a multiple of the 1KiB block. Stores the 8 digest bytes in out.
+     * @note   Only the accumulators and the last 64 bytes of the piece before are carried over, so the digest matches XENON_HF_xxh3 over the whole file.
+     */
+    inline bool XENON_HF_xxh3_file(XENON_HF_file_reader& file, const size_t block, uint8_t* out) noexcept {
+        return XENON_HF_xxh3_kernels([&](auto&& accumulate, auto&& scramble) {
+            XENON_HF_xxh3_state state;
+            uint64_t total = 0;
+            uint8_t previous[64];
+            return XENON_HF_read_pieces(file, block, [&](const char* data, const size_t size, const bool last) {
+                const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+                total += size;
+                if(last && total == size)
+                    XENON_HF_store_big_endian(out, XENON_HF_xxh3(bytes, size), 8);
+                else if(last)
+                    XENON_HF_store_big_endian(out, XENON_HF_xxh3_finish(state, bytes, size, previous, total, accumulate, scramble), 8);
+                else {
+                    // More input follows, so every block of this piece is a whole one
+                    XENON_HF_xxh3_blocks(state, bytes, size / XENON_HF_xxh3_block, accumulate, scramble);
+                    std::memcpy(previous, bytes + size - 64, 64);
+                }
+            });
+        });
+    }
+
+    // BLAKE3
+
+    inline constexpr uint32_t XENON_HF_blake3_iv[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+    inline constexpr uint32_t XENON_HF_blake3_chunk_start = 1, XENON_HF_blake3_chunk_end = 2, XENON_HF_blake3_parent = 4, XENON_HF_blake3_root = 8;
+    inline constexpr size_t XENON_HF_blake3_chunk = 1024;
+    // Chunks per subtree that one job hashes. A power of two, so every full group is a subtree of its own
+    inline constexpr size_t XENON_HF_blake3_group = 4096;
+
+    struct XENON_HF_blake3_schedule {
+        // Which message word goes where in each of the 7 rounds
+        uint8_t order[7][16];
+    };
+
+    inline constexpr XENON_HF_blake3_schedule XENON_HF_blake3_make_schedule(void) noexcept {
+        constexpr uint8_t permutation[16] = { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 };
+        XENON_HF_blake3_schedule schedule = {};
+        for(uint8_t i = 0; i < 16; ++i)
+            schedule.order[0][i] = i;
+        for(int round = 1; round < 7; ++round)
+            for(int i = 0; i < 16; ++i)
+                schedule.order[round][i] = schedule.order[round - 1][permutation[i]];
+        return schedule;
+    }
+
+    inline constexpr XENON_HF_blake3_schedule XENON_HF_blake3_schedule_table = XENON_HF_blake3_make_schedule();
+
+    inline void XENON_HF_blake3_g(uint32_t* state, const int a, const int b, const int c, const int d, const uint32_t x, const uint32_t y) noexcept {
+        state[a] += state[b] + x;
+        state[d] = std::rotr(state[d] ^ state[a], 16);
+        state[c] += state[d];
+        state[b] = std::rotr(state[b] ^ state[c], 12);
+        state[a] += state[b] + y;
+        state[d] = std::rotr(state[d] ^ state[a], 8);
+        state[c] += state[d];
+        state[b] = std::rotr(state[b] ^ state[c], 7);
+    }
+
+    /**
+     * @brief Compresses one block into the chaining value in place.
+     */
+    inline void XENON_HF_blake3_compress(uint32_t* chaining, const uint32_t* words, const uint32_t block_size, const uint64_t counter, const uint32_t flags) noexcept {
+        uint32_t state[16] = { chaining[0], chaining[1], chaining[2], chaining[3], chaining[4], chaining[5], chaining[6], chaining[7], XENON_HF_blake3_iv[0], XENON_HF_blake3_iv[1], XENON_HF_blake3_iv[2], XENON_HF_blake3_iv[3], static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32), block_size, flags };
+        for(int round = 0; round < 7; ++round) {
+            const uint8_t* const order = XENON_HF_blake3_schedule_table.order[round];
+            XENON_HF_blake3_g(state, 0, 4, 8, 12, words[order[0]], words[order[1]]);
+            XENON_HF_blake3_g(state, 1, 5, 9, 13, words[order[2]], words[order[3]]);
+            XENON_HF_blake3_g(state, 2, 6, 10, 14, words[order[4]], words[order[5]]);
+            XENON_HF_blake3_g(state, 3, 7, 11, 15, words[order[6]], words[order[7]]);
+            XENON_HF_blake3_g(state, 0, 5, 10, 15, words[order[8]], words[order[9]]);
+            XENON_HF_blake3_g(state, 1, 6, 11, 12, words[order[10]], words[order[11]]);
+            XENON_HF_blake3_g(state, 2, 7, 8, 13, words[order[12]], words[order[13]]);
+            XENON_HF_blake3_g(state, 3, 4, 9, 14, words[order[14]], words[order[15]]);
+        }
+        for(int i = 0; i < 8; ++i)
+            chaining[i] = state[i] ^ state[i + 8];
+    }
+
+    using XENON_HF_blake3_cv = std::array<uint32_t, 8>;
+
+    /**
+     * @brief The chaining value of one chunk of up to 1KiB. An empty chunk is one empty block.
+     */
+    inline XENON_HF_blake3_cv XENON_HF_blake3_chunk_cv(const uint8_t* data, const size_t size, const uint64_t counter, const uint32_t last_flags) noexcept {
+        XENON_HF_blake3_cv chaining;
+        std::copy(std::begin(XENON_HF_blake3_iv), std::end(XENON_HF_blake3_iv), chaining.begin());
+        const size_t blocks = size == 0 ? 1 : (size + 63) / 64;
+        for(size_t block = 0; block < blocks; ++block) {
+            const size_t used = std::min<size_t>(64, size - block * 64);
+            uint8_t bytes[64] = {};
+            std::memcpy(bytes, data + block * 64, used);
+            uint32_t words[16];
+            for(int i = 0; i < 16; ++i)
+                words[i] = XENON_HF_read32(bytes + 4 * i);
+            const uint32_t flags = (block == 0 ? XENON_HF_blake3_chunk_start : 0) | (block + 1 == blocks ? XENON_HF_blake3_chunk_end | last_flags : 0);
+            XENON_HF_blake3_compress(chaining.data(), words, static_cast<uint32_t>(used), counter, flags);
+        }
+        return chaining;
+    }
+
+    inline XENON_HF_blake3_cv XENON_HF_blake3_parent_cv(const XENON_HF_blake3_cv& left, const XENON_HF_blake3_cv& right, const uint32_t flags) noexcept {
+        XENON_HF_blake3_cv chaining;
+        std::copy(std::begin(XENON_HF_blake3_iv), std::end(XENON_HF_blake3_iv), chaining.begin());
+        uint32_t words[16];
+        std::copy(left.begin(), left.end(), words);
+        std::copy(right.begin(), right.end(), words + 8);
+        XENON_HF_blake3_compress(chaining.data(), words, 64, 0, XENON_HF_blake3_parent | flags);
+        return chaining;
+    }
+
+#ifdef XENON_M_X86
+    XENON_M_TARGET("avx2") inline void XENON_HF_blake3_transpose_avx2(__m256i* rows) noexcept {
+        const __m256i ab_0145 = _mm256_unpacklo_epi32(rows[0], rows[1]), ab_2367 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+        const __m256i cd_0145 = _mm256_unpacklo_epi32(rows[2], rows[3]), cd_2367 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+        const __m256i ef_0145 = _mm256_unpacklo_epi32(rows[4], rows[5]), ef_2367 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+        const __m256i gh_0145 = _mm256_unpacklo_epi32(rows[6], rows[7]), gh_2367 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+        const __m256i abcd_04 = _mm256_unpacklo_epi64(ab_0145, cd_0145), abcd_15 = _mm256_unpackhi_epi64(ab_0145, cd_0145);
+        const __m256i abcd_26 = _mm256_unpacklo_epi64(ab_2367, cd_2367), abcd_37 = _mm256_unpackhi_epi64(ab_2367, cd_2367);
+        const __m256i efgh_04 = _mm256_unpacklo_epi64(ef_0145, gh_0145), efgh_15 = _mm256_unpackhi_epi64(ef_0145, gh_0145);
+        const __m256i efgh_26 = _mm256_unpacklo_epi64(ef_2367, gh_2367), efgh_37 = _mm256_unpackhi_epi64(ef_2367, gh_2367);
+        rows[0] = _mm256_permute2x128_si256(abcd_04, efgh_04, 0x20);
+        rows[1] = _mm256_permute2x128_si256(abcd_15, efgh_15, 0x20);
+        rows[2] = _mm256_permute2x128_si256(abcd_26, efgh_26, 0x20);
+        rows[3] = _mm256_permute2x128_si256(abcd_37, efgh_37, 0x20);
+        rows[4] = _mm256_permute2x128_si256(abcd_04, efgh_04, 0x31);
+        rows[5] = _mm256_permute2x128_si256(abcd_15, efgh_15, 0x31);
+        rows[6] = _mm256_permute2x128_si256(abcd_26, efgh_26, 0x31);
+        rows[7] = _mm256_permute2x128_si256(abcd_37, efgh_37, 0x31);
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_blake3_g_avx2(__m256i* state, const int a, const int b, const int c, const int d, const __m256i x, const __m256i y) noexcept {
+        const __m256i rotate16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+        const __m256i rotate8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+        state[a] = _mm256_add_epi32(_mm256_add_epi32(state[a], state[b]), x);
+        state[d] = _mm256_shuffle_epi8(_mm256_xor_si256(state[d], state[a]), rotate16);
+        state[c] = _mm256_add_epi32(state[c], state[d]);
+        state[b] = _mm256_xor_si256(state[b], state[c]);
+        state[b] = _mm256_or_si256(_mm256_srli_epi32(state[b], 12), _mm256_slli_epi32(state[b], 20));
+        state[a] = _mm256_add_epi32(_mm256_add_epi32(state[a], state[b]), y);
+        state[d] = _mm256_shuffle_epi8(_mm256_xor_si256(state[d], state[a]), rotate8);
+        state[c] = _mm256_add_epi32(state[c], state[d]);
+        state[b] = _mm256_xor_si256(state[b], state[c]);
+        state[b] = _mm256_or_si256(_mm256_srli_epi32(state[b], 7), _mm256_slli_epi32(state[b], 25));
+    }
+
+    /**
+     * @brief Hashes 8 whole chunks that follow each other, one per lane, which is how BLAKE3 gets its speed: the chunks don't depend on each other.
+     */
+    XENON_M_TARGET("avx2") inline void XENON_HF_blake3_chunks_avx2(const uint8_t* data, const uint64_t counter, XENON_HF_blake3_cv* chaining) noexcept {
+        __m256i hashes[8];
+        for(int i = 0; i < 8; ++i)
+            hashes[i] = _mm256_set1_epi32(static_cast<int>(XENON_HF_blake3_iv[i]));
+        // Lane j hashes chunk counter + j, and the low halves can carry into the high ones
+        const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000));
+        const __m256i low_base = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(counter)));
+        const __m256i low = _mm256_add_epi32(low_base, _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        const __m256i carry = _mm256_cmpgt_epi32(_mm256_xor_si256(low_base, sign), _mm256_xor_si256(low, sign));
+        const __m256i high = _mm256_sub_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(counter >> 32))), carry);
+
+        for(size_t block = 0; block < XENON_HF_blake3_chunk / 64; ++block) {
+            __m256i words[16];
+            for(size_t lane = 0; lane < 8; ++lane) {
+                words[lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + lane * XENON_HF_blake3_chunk + block * 64));
+                words[lane + 8] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + lane * XENON_HF_blake3_chunk + block * 64 + 32));
+            }
+            XENON_HF_blake3_transpose_avx2(words);
+            XENON_HF_blake3_transpose_avx2(words + 8);
+
+            const uint32_t flags = (block == 0 ? XENON_HF_blake3_chunk_start : 0) | (block + 1 == XENON_HF_blake3_chunk / 64 ? XENON_HF_blake3_chunk_end : 0);
+            __m256i state[16] = { hashes[0], hashes[1], hashes[2], hashes[3], hashes[4], hashes[5], hashes[6], hashes[7], _mm256_set1_epi32(static_cast<int>(XENON_HF_blake3_iv[0])), _mm256_set1_epi32(static_cast<int>(XENON_HF_blake3_iv[1])), _mm256_set1_epi32(static_cast<int>(XENON_HF_blake3_iv[2])), _mm256_set1_epi32(static_cast<int>(XENON_HF_blake3_iv[3])), low, high, _mm256_set1_epi32(64), _mm256_set1_epi32(static_cast<int>(flags)) };
+            for(int round = 0; round < 7; ++round) {
+                const uint8_t* const order = XENON_HF_blake3_schedule_table.order[round];
+                XENON_HF_blake3_g_avx2(state, 0, 4, 8, 12, words[order[0]], words[order[1]]);
+                XENON_HF_blake3_g_avx2(state, 1, 5, 9, 13, words[order[2]], words[order[3]]);
+                XENON_HF_blake3_g_avx2(state, 2, 6, 10, 14, words[order[4]], words[order[5]]);
+                XENON_HF_blake3_g_avx2(state, 3, 7, 11, 15, words[order[6]], words[order[7]]);
+                XENON_HF_blake3_g_avx2(state, 0, 5, 10, 15, words[order[8]], words[order[9]]);
+                XENON_HF_blake3_g_avx2(state, 1, 6, 11, 12, words[order[10]], words[order[11]]);
+                XENON_HF_blake3_g_avx2(state, 2, 7, 8, 13, words[order[12]], words[order[13]]);
+                XENON_HF_blake3_g_avx2(state, 3, 4, 9, 14, words[order[14]], words[order[15]]);
+            }
+            for(int i = 0; i < 8; ++i)
+                hashes[i] = _mm256_xor_si256(state[i], state[i + 8]);
+        }
+
+        XENON_HF_blake3_transpose_avx2(hashes);
+        for(size_t lane = 0; lane < 8; ++lane)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(chaining[lane].data()), hashes[lane]);
+    }
+#endif // XENON_M_X86
+
+    /**
+     * @brief The chaining values of every chunk in a range. The range starts on a chunk boundary and isn't empty.
+     */
+    inline void XENON_HF_blake3_chunk_cvs(const uint8_t* data, const size_t size, const uint64_t counter, std::vector<XENON_HF_blake3_cv>& chaining) noexcept {
+        const size_t chunks = (size + XENON_HF_blake3_chunk - 1) / XENON_HF_blake3_chunk, whole = size / XENON_HF_blake3_chunk;
+        chaining.resize(chunks);
+        size_t chunk = 0;
+#ifdef XENON_M_X86
+        static const bool avx2 = xenon::utilities::cpu().avx2;
+        if(avx2)
+            for(; chunk + 8 <= whole; chunk += 8)
+                XENON_HF_blake3_chunks_avx2(data + chunk * XENON_HF_blake3_chunk, counter + chunk, chaining.data() + chunk);
+#endif // XENON_M_X86
+        for(; chunk < chunks; ++chunk)
+            chaining[chunk] = XENON_HF_blake3_chunk_cv(data + chunk * XENON_HF_blake3_chunk, std::min(XENON_HF_blake3_chunk, size - chunk * XENON_HF_blake3_chunk), counter + chunk, 0);
+    }
+
+    /**
+     * @brief Joins chaining values into the tree BLAKE3 defines: the left subtree always holds the biggest power of two of them that leaves the right one something.
+     */
+    inline XENON_HF_blake3_cv XENON_HF_blake3_merge(const XENON_HF_blake3_cv* chaining, const size_t count, const uint32_t flags) noexcept {
+        if(count == 1)
+            return chaining[0];
+        const size_t left = std::bit_floor(count - 1);
+        return XENON_HF_blake3_parent_cv(XENON_HF_blake3_merge(chaining, left, 0), XENON_HF_blake3_merge(chaining + left, count - left, 0), flags);
+    }
+
+    /**
+     * @brief The chaining value of a group of chunks that starts on a group boundary.
+     */
+    inline XENON_HF_blake3_cv XENON_HF_blake3_group_cv(const uint8_t* data, const size_t size, const uint64_t counter, const uint32_t flags) noexcept {
+        thread_local std::vector<XENON_HF_blake3_cv> chaining;
+        XENON_HF_blake3_chunk_cvs(data, size, counter, chaining);
+        return XENON_HF_blake3_merge(chaining.data(), chaining.size(), flags);
+    }
+
+    /**
+     * @brief BLAKE3 with the default 32 byte output. Groups of 4MiB are hashed on the pool, and their chaining values are joined at the end like chunks are.
+     */
+    // Bytes in a group
+    inline constexpr size_t XENON_HF_blake3_group_size = XENON_HF_blake3_chunk * XENON_HF_blake3_group;
+
+    /**
+     * @brief Appends the chaining values of the groups in a range that starts on a group boundary. Only the last group can be partial.
+     */
+    inline void XENON_HF_blake3_groups(const uint8_t* data, const size_t size, const bool parallel, xenon::async::thread_pool& pool, std::vector<XENON_HF_blake3_cv>& chaining) noexcept {
+        const size_t first = chaining.size(), groups = (size + XENON_HF_blake3_group_size - 1) / XENON_HF_blake3_group_size;
+        chaining.resize(first + groups);
+        const auto hash_groups = [&](const size_t begin, const size_t end) {
+            for(size_t i = begin; i < end; ++i)
+                chaining[first + i] = XENON_HF_blake3_group_cv(data + i * XENON_HF_blake3_group_size, std::min(XENON_HF_blake3_group_size, size - i * XENON_HF_blake3_group_size), static_cast<uint64_t>(first + i) * XENON_HF_blake3_group, 0);
+        };
+        if(parallel)
+            XENON_HF_parallel_chunks(groups, 1, pool, hash_groups);
+        else
+            hash_groups(0, groups);
+    }
+
+    inline XENON_HF_blake3_cv XENON_HF_blake3(const uint8_t* data, const size_t size, const bool parallel, xenon::async::thread_pool& pool) noexcept {
+        if(size <= XENON_HF_blake3_chunk)
+            return XENON_HF_blake3_chunk_cv(data, size, 0, XENON_HF_blake3_root);
+        if(size <= XENON_HF_blake3_group_size)
+            return XENON_HF_blake3_group_cv(data, size, 0, XENON_HF_blake3_root);
+        std::vector<XENON_HF_blake3_cv> chaining;
+        XENON_HF_blake3_groups(data, size, parallel, pool, chaining);
+        return XENON_HF_blake3_merge(chaining.data(), chaining.size(), XENON_HF_blake3_root);
+    }
+
+    // CRC32C of a buffer that can be split across the pool
+
+    inline uint32_t XENON_HF_crc32c_buffer(const uint8_t* data, const size_t size, const bool parallel, xenon::async::thread_pool& pool) noexcept {
+        if(!parallel) [[likely]]
+            return XENON_HF_crc32c(data, size);
+        // Pieces are checksummed on their own and joined with the combine identity
+        constexpr size_t piece = size_t(4) << 20;
+        std::vector<uint32_t> pieces((size + piece - 1) / piece);
+        XENON_HF_parallel_chunks(pieces.size(), 1, pool, [&](const size_t begin, const size_t end) {
+            for(size_t i = begin; i < end; ++i)
+                pieces[i] = XENON_HF_crc32c(data + i * piece, std::min(piece, size - i * piece));
+        });
+        uint32_t value = pieces[0];
+        for(size_t i = 1; i < pieces.size(); ++i)
+            value = XENON_HF_crc32c_combine(value, pieces[i], std::min(piece, size - i * piece));
+        return value;
+    }
+
+    // BLAKE3 digests are the chaining value's words in little-endian order
+
+    inline void XENON_HF_store_blake3(uint8_t* out, const XENON_HF_blake3_cv& value) noexcept {
+        for(size_t i = 0; i < 32; ++i)
+            out[i] = static_cast<uint8_t>(value[i / 4] >> (8 * (i % 4)));
+    }
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Hash functions that hash_file can use.
+         * @note
+         */
+        enum class hash_algorithm {
+            // XXH3-64: the fastest, for deduplication and change detection. Not cryptographic
+            xxh3,
+            // CRC32C(Castagnoli), the checksum of iSCSI, ext4 and many storage formats. Uses SSE4.2 where available
+            crc32c,
+            // BLAKE3-256: cryptographic, and still fast because its tree splits across SIMD lanes and threads
+            blake3
+        };
+
+        /**
+         * @brief A hash of up to 32 bytes.
+         * @note   Bytes are in the order the reference tools print them: big-endian for xxh3 and crc32c.
+         */
+        struct hash_digest {
+            std::array<uint8_t, 32> bytes = {};
+            uint8_t size = 0;
+
+            /**
+             * @brief Formats the digest as lowercase hexadecimal.
+             * @note   The same string xxhsum -H3, crc32c tools and b3sum print.
+             * @retval The string
+             */
+            [[nodiscard]] std::string hex(void) const noexcept {
+                constexpr char digits[] = "0123456789abcdef";
+                std::string text(size_t(size) * 2, '0');
+                for(size_t i = 0; i < size; ++i) {
+                    text[2 * i] = digits[bytes[i] >> 4];
+                    text[2 * i + 1] = digits[bytes[i] & 0xF];
+                }
+                return text;
+            }
+
+            [[nodiscard]] bool operator==(const hash_digest& other) const noexcept = default;
+        };
+
+        /**
+         * @brief Buffers at least this big are hashed on several threads.
+         * @note   XXH3 is always hashed on one thread: it's defined as one stream, and at its speed the memory is the bottleneck anyway.
+         */
+        inline constexpr size_t parallel_hash_threshold = size_t(64) << 20;
+
+        /**
+         * @brief Hashes a buffer.
+         * @note   crc32c and blake3 buffers of parallel_hash_threshold bytes and more are split across the pool. The result is the same either way.
+         * @param  data: The buffer
+         * @param  algorithm: The hash function
+         * @param  pool: The pool to hash on
+         * @retval The digest
+         */
+        [[nodiscard]] inline hash_digest hash_buffer(const std::span<const std::byte> data, const hash_algorithm algorithm, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data.data());
+            const bool parallel = data.size() >= parallel_hash_threshold && pool.size() > 1;
+            hash_digest digest;
+            switch(algorithm) {
+            case hash_algorithm::xxh3:
+                digest.size = 8;
+                XENON_HF_store_big_endian(digest.bytes.data(), XENON_HF_xxh3(bytes, data.size()), 8);
+                break;
+            case hash_algorithm::crc32c:
+                digest.size = 4;
+                XENON_HF_store_big_endian(digest.bytes.data(), XENON_HF_crc32c_buffer(bytes, data.size(), parallel, pool), 4);
+                break;
+            case hash_algorithm::blake3:
+                digest.size = 32;
+                XENON_HF_store_blake3(digest.bytes.data(), XENON_HF_blake3(bytes, data.size(), parallel, pool));
+                break;
+            }
+            return digest;
+        }
+
+        /**
+         * @brief Hashes text.
+         * @note   Same as the span overload.
+         * @param  text: The text
+         * @param  algorithm: The hash function
+         * @param  pool: The pool to hash on
+         * @retval The digest
+         */
+        [[nodiscard]] inline hash_digest hash_buffer(const std::string_view text, const hash_algorithm algorithm, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            return hash_buffer(std::span<const std::byte>(reinterpret_cast<const std::byte*>(text.data()), text.size()), algorithm, pool);
+        }
+
+        /**
+         * @brief Hashes a file that is read in blocks of parallel_hash_threshold bytes, so it never has to fit in memory.
+         * @note   Each block is hashed like hash_buffer would, so big files are still split across the pool. The digest is the same as hash_buffer's of the whole file.
+         *         A file that is truncated meanwhile is hashed up to where it ended. Pipes and /proc are read until they end.
+         * @param  path: The path for the specified file
+         * @param  algorithm: The hash function
+         * @param  pool: The pool to hash big files on
+         * @retval The digest, or nothing if the file couldn't be read
+         */
+        [[nodiscard]] inline std::optional<hash_digest> hash_file(const std::string& path, const hash_algorithm algorithm, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::hash_file");
+            XENON_HF_file_reader file(path);
+            if(!file.is_open()) [[unlikely]]
+                return std::nullopt;
+            const bool parallel = pool.size() > 1;
+            hash_digest digest;
+            bool read = false;
+            switch(algorithm) {
+            case hash_algorithm::xxh3:
+                read = XENON_HF_xxh3_file(file, parallel_hash_threshold, digest.bytes.data());
+                digest.size = 8;
+                break;
+            case hash_algorithm::crc32c: {
+                uint32_t value = 0;
+                bool first = true;
+                read = XENON_HF_read_pieces(file, parallel_hash_threshold, [&](const char* data, const size_t size, const bool) {
+                    const uint32_t piece = XENON_HF_crc32c_buffer(reinterpret_cast<const uint8_t*>(data), size, parallel && size >= parallel_hash_threshold, pool);
+                    value = first ? piece : XENON_HF_crc32c_combine(value, piece, size);
+                    first = false;
+                });
+                digest.size = 4;
+                XENON_HF_store_big_endian(digest.bytes.data(), value, 4);
+                break;
+            }
+            case hash_algorithm::blake3: {
+                std::vector<XENON_HF_blake3_cv> chaining;
+                bool first = true;
+                read = XENON_HF_read_pieces(file, parallel_hash_threshold, [&](const char* data, const size_t size, const bool last) {
+                    const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+                    // Pieces are whole groups apart from the last, so their groups continue where the ones before stopped
+                    if(first && last)
+                        XENON_HF_store_blake3(digest.bytes.data(), XENON_HF_blake3(bytes, size, parallel && size >= parallel_hash_threshold, pool));
+                    else {
+                        XENON_HF_blake3_groups(bytes, size, parallel && size >= parallel_hash_threshold, pool, chaining);
+                        if(last)
+                            XENON_HF_store_blake3(digest.bytes.data(), XENON_HF_blake3_merge(chaining.data(), chaining.size(), XENON_HF_blake3_root));
+                    }
+                    first = false;
+                });
+                digest.size = 32;
+                break;
+            }
+            }
+            if(!read) [[unlikely]]
+                return std::nullopt;
+            return digest;
+        }
+
+        /**
+         * @brief Hashes every file in a directory tree.
+         * @note   The tree is walked with walk(), and the files are hashed in parallel on the pool. Symlinks aren't followed, and files that can't be read are left out.
+         * @param  path: The path to the specified directory
+         * @param  algorithm: The hash function
+         * @param  options: Depth and glob filters for the walk
+         * @param  pool: The pool to walk and hash on
+         * @retval Pairs of file paths and digests, sorted by path
+         */
+        [[nodiscard]] inline std::vector<std::pair<std::string, hash_digest>> hash_folder(const std::string& path, const hash_algorithm algorithm, const walk_options& options = {}, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::hash_folder");
+            std::mutex mutex;
+            std::vector<std::string> paths;
+            walk(path, [&](const walk_entry& entry) {
+                if(entry.type != entry_type::file)
+                    return;
+                std::lock_guard<std::mutex> lock(mutex);
+                paths.emplace_back(entry.path);
+            }, options, pool);
+            std::sort(paths.begin(), paths.end());
+
+            // One file per job, since file sizes vary too much for bigger ones to balance
+            std::vector<std::optional<hash_digest>> digests(paths.size());
+            xenon::async::parallel_for(size_t(0), paths.size(), [&](const size_t i) {
+                digests[i] = hash_file(paths[i], algorithm, pool);
+            }, 1, pool);
+
+            std::vector<std::pair<std::string, hash_digest>> hashes;
+            hashes.reserve(paths.size());
+            for(size_t i = 0; i < paths.size(); ++i)
+                if(digests[i].has_value())
+                    hashes.emplace_back(std::move(paths[i]), *digests[i]);
+            return hashes;
+        }
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_HASH
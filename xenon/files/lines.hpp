@@ -0,0 +1,178 @@
+// lines.hpp
+//
+// A lazy line range class that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_LINES
+#define XENON_HG_FILES_LINES
+
+// Libraries
+#include <string>
+#include <string_view>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Reads a file line by line through one reusable block buffer, so files bigger than RAM can be streamed without an allocation per line.
+         * @note   Lines are split the way std::getline does. A view stays valid until the iterator is incremented, so copy the lines you keep(iter_value_t is std::string for that reason).
+         *         Memory is bounded by the block size, or by the longest line if that is longer. Single-pass.
+         */
+        class lines final {
+        public:
+            /**
+             * @brief Default size of the block buffer.
+             * @note
+             */
+            static constexpr size_t default_block_size = size_t(1) << 20;
+
+            class iterator final {
+            public:
+                using iterator_concept = std::input_iterator_tag;
+                using value_type = std::string;
+                using reference = std::string_view;
+                using difference_type = std::ptrdiff_t;
+
+                iterator(void) noexcept = default;
+
+                explicit iterator(lines* owner) noexcept
+                    : m_owner(owner) {}
+
+                [[nodiscard]] std::string_view operator*(void) const noexcept {
+                    return m_owner->m_line;
+                }
+
+                iterator& operator++(void) noexcept {
+                    m_owner->next();
+                    return *this;
+                }
+
+                void operator++(int) noexcept {
+                    m_owner->next();
+                }
+
+                [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {
+                    return m_owner == nullptr || m_owner->m_done;
+                }
+            private:
+                lines* m_owner = nullptr;
+            };
+
+            /**
+             * @brief Opens a file for reading its lines.
+             * @note   Check is_open() afterwards. A file that can't be opened has no lines.
+             * @param  path: The path for the specified file
+             * @param  block_size: How many bytes are read at once
+             */
+            explicit lines(const std::string& path, const size_t block_size = default_block_size) noexcept
+                : m_file(std::fopen(path.c_str(), "rb")), m_capacity(block_size > 0 ? block_size : default_block_size) {
+                if(m_file == nullptr) [[unlikely]] {
+                    m_done = true;
+                    return;
+                }
+                // The block buffer is the only buffer, the stream's own one would copy everything twice
+                std::setvbuf(m_file, nullptr, _IONBF, 0);
+                m_buffer.reset(new(std::nothrow) char[m_capacity]);
+                if(m_buffer == nullptr) [[unlikely]]
+                    m_done = true;
+            }
+
+            lines(const lines&) = delete;
+            lines& operator=(const lines&) = delete;
+
+            /**
+             * @brief Checks whether the file was opened.
+             * @note
+             * @retval True if open
+             */
+            [[nodiscard]] bool is_open(void) const noexcept {
+                return m_file != nullptr;
+            }
+
+            /**
+             * @brief Reads the first line and gives an iterator to it.
+             * @note   Call once, the lines can't be read again.
+             * @retval The iterator
+             */
+            [[nodiscard]] iterator begin(void) noexcept {
+                if(!m_started) {
+                    m_started = true;
+                    next();
+                }
+                return iterator(this);
+            }
+
+            [[nodiscard]] std::default_sentinel_t end(void) const noexcept {
+                return std::default_sentinel;
+            }
+
+            ~lines(void) noexcept {
+                if(m_file != nullptr)
+                    std::fclose(m_file);
+            }
+        private:
+            void next(void) noexcept {
+                for(;;) {
+                    if(m_done) [[unlikely]]
+                        return;
+                    const char* const start = m_buffer.get() + m_position;
+                    const size_t left = m_filled - m_position;
+                    if(const char* const newline = static_cast<const char*>(std::memchr(start, '\n', left)); newline != nullptr) [[likely]] {
+                        m_line = std::string_view(start, static_cast<size_t>(newline - start));
+                        m_position += m_line.size() + 1;
+                        return;
+                    }
+                    if(m_eof) {
+                        // The last line has no newline after it
+                        m_line = std::string_view(start, left);
+                        m_position = m_filled;
+                        m_done = left == 0;
+                        return;
+                    }
+                    refill();
+                }
+            }
+
+            /**
+             * @brief Moves the unfinished line to the front and reads behind it, growing the buffer only when a single line doesn't fit.
+             */
+            void refill(void) noexcept {
+                const size_t left = m_filled - m_position;
+                if(left == m_capacity) [[unlikely]] {
+                    std::unique_ptr<char[]> bigger(new(std::nothrow) char[m_capacity * 2]);
+                    if(bigger == nullptr) [[unlikely]] {
+                        m_done = true;
+                        return;
+                    }
+                    std::memcpy(bigger.get(), m_buffer.get(), left);
+                    m_buffer = std::move(bigger);
+                    m_capacity *= 2;
+                }
+                else if(m_position > 0)
+                    std::memmove(m_buffer.get(), m_buffer.get() + m_position, left);
+                m_position = 0;
+                m_filled = left;
+                const size_t read = std::fread(m_buffer.get() + m_filled, 1, m_capacity - m_filled, m_file);
+                m_filled += read;
+                if(read == 0)
+                    m_eof = true;
+            }
+
+            std::FILE* m_file = nullptr;
+            std::unique_ptr<char[]> m_buffer;
+            size_t m_capacity = default_block_size;
+            size_t m_position = 0;
+            size_t m_filled = 0;
+            std::string_view m_line;
+            bool m_started = false;
+            bool m_eof = false;
+            bool m_done = false;
+        };
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_LINES
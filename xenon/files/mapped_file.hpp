@@ -0,0 +1,432 @@
+// mapped_file.hpp
+//
+// A memory-mapped file class that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_MAPPED_FILE
+#define XENON_HG_FILES_MAPPED_FILE
+
+#include "../macros.hpp"
+
+// Libraries
+#include <span>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef XENON_M_WIN
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+// Windows.h would define min and max as macros otherwise
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif // XENON_M_WIN
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    /**
+     * @brief A file that is read front to back with system calls. Unlike a mapping, it keeps working when the file shrinks meanwhile, the reads just end early.
+     */
+    class XENON_HF_file_reader final {
+    public:
+        explicit XENON_HF_file_reader(const std::string& path) noexcept {
+#ifdef XENON_M_WIN
+            m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if(m_file == INVALID_HANDLE_VALUE) [[unlikely]]
+                return;
+            LARGE_INTEGER size;
+            if(GetFileType(m_file) == FILE_TYPE_DISK && GetFileSizeEx(m_file, &size)) [[likely]]
+                m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+            m_file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if(m_file == -1) [[unlikely]]
+                return;
+            struct stat info;
+            if(fstat(m_file, &info) == 0 && S_ISREG(info.st_mode)) [[likely]]
+                m_size = static_cast<uint64_t>(info.st_size);
+#ifdef XENON_M_LINUX
+            posix_fadvise(m_file, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // XENON_M_LINUX
+#endif // XENON_M_WIN
+        }
+
+        XENON_HF_file_reader(const XENON_HF_file_reader&) = delete;
+        XENON_HF_file_reader& operator=(const XENON_HF_file_reader&) = delete;
+
+        ~XENON_HF_file_reader(void) noexcept {
+#ifdef XENON_M_WIN
+            if(m_file != INVALID_HANDLE_VALUE)
+                CloseHandle(m_file);
+#else
+            if(m_file != -1)
+                ::close(m_file);
+#endif // XENON_M_WIN
+        }
+
+        [[nodiscard]] bool is_open(void) const noexcept {
+#ifdef XENON_M_WIN
+            return m_file != INVALID_HANDLE_VALUE;
+#else
+            return m_file != -1;
+#endif // XENON_M_WIN
+        }
+
+        // The size when the file was opened, 0 if it's unknown(pipes, /proc and such)
+        [[nodiscard]] uint64_t size(void) const noexcept {
+            return m_size;
+        }
+
+        /**
+         * @brief Reads until out is full or the file ends.
+         * @retval How many bytes were read, fewer than asked for only at the end of the file. -1 on an error
+         */
+        int64_t fill(char* out, const size_t size) noexcept {
+            size_t done = 0;
+            while(done < size) {
+                // Both APIs cap one call below 2GiB
+                const size_t step = std::min<size_t>(size - done, size_t(1) << 30);
+#ifdef XENON_M_WIN
+                DWORD read = 0;
+                if(!ReadFile(m_file, out + done, static_cast<DWORD>(step), &read, nullptr)) [[unlikely]]
+                    return -1;
+#else
+                const ssize_t read = ::read(m_file, out + done, step);
+                if(read < 0) [[unlikely]] {
+                    if(errno == EINTR)
+                        continue;
+                    return -1;
+                }
+#endif // XENON_M_WIN
+                if(read == 0)
+                    break;
+                done += static_cast<size_t>(read);
+            }
+            return static_cast<int64_t>(done);
+        }
+    private:
+#ifdef XENON_M_WIN
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+#else
+        int m_file = -1;
+#endif // XENON_M_WIN
+        uint64_t m_size = 0;
+    };
+
+    /**
+     * @brief Reads a whole file into a string that is sized from the file up front, so it's read with as few calls as possible and copied once.
+     * @note   A file that shrinks meanwhile gives what was left of it. Files of an unknown size are read until they end, doubling the string.
+     */
+    inline std::optional<std::string> XENON_HF_read_file(const std::string& path) noexcept {
+        XENON_HF_file_reader file(path);
+        if(!file.is_open()) [[unlikely]]
+            return std::nullopt;
+        std::string text;
+        size_t done = 0;
+        for(size_t capacity = file.size() > 0 ? static_cast<size_t>(file.size()) : size_t(64) << 10;; capacity *= 2) {
+            text.resize(capacity);
+            const int64_t read = file.fill(text.data() + done, capacity - done);
+            if(read < 0) [[unlikely]]
+                return std::nullopt;
+            done += static_cast<size_t>(read);
+            // A known size is where the file ended when it was opened, so reading stops there even if it grew since
+            if(done < capacity || file.size() > 0)
+                break;
+        }
+        text.resize(done);
+        return text;
+    }
+
+    /**
+     * @brief Reads a file in pieces of block bytes and calls piece_func(data, size, last) with each one.
+     * @note   Every piece but the last has exactly block bytes, and the last one has at least one byte unless the file is empty.
+     *         The buffer starts at the size of the file and only grows to block + 1 bytes for bigger files: one byte past a piece is read ahead to know whether it's the last.
+     * @retval False if the file couldn't be read
+     */
+    template<typename F>
+    inline bool XENON_HF_read_pieces(XENON_HF_file_reader& file, const size_t block, F&& piece_func) noexcept {
+        size_t capacity = std::min<size_t>(file.size() > 0 ? static_cast<size_t>(file.size()) + 1 : size_t(64) << 10, block + 1);
+        std::unique_ptr<char[]> buffer(new(std::nothrow) char[capacity]);
+        if(buffer == nullptr) [[unlikely]]
+            return false;
+        for(size_t filled = 0;;) {
+            const int64_t read = file.fill(buffer.get() + filled, capacity - filled);
+            if(read < 0) [[unlikely]]
+                return false;
+            filled += static_cast<size_t>(read);
+            if(filled < capacity) {
+                piece_func(buffer.get(), filled, true);
+                return true;
+            }
+            if(capacity < block + 1) {
+                // The file is bigger than it was, or its size is unknown
+                const size_t bigger = std::min(capacity * 2, block + 1);
+                std::unique_ptr<char[]> grown(new(std::nothrow) char[bigger]);
+                if(grown == nullptr) [[unlikely]]
+                    return false;
+                std::memcpy(grown.get(), buffer.get(), filled);
+                buffer = std::move(grown);
+                capacity = bigger;
+                continue;
+            }
+            piece_func(buffer.get(), block, false);
+            buffer[0] = buffer[block];
+            filled = 1;
+        }
+    }
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief How a mapped file is going to be read, so the OS can read ahead or back off accordingly.
+         * @note   Hints that the OS doesn't support are ignored.
+         */
+        enum class access_hint {
+            normal,
+            // Reads ahead aggressively and drops pages behind
+            sequential,
+            // Turns read-ahead off
+            random,
+            // Starts reading the whole file in now
+            willneed,
+            // Backs the mapping with huge pages where the file system allows it
+            hugepage
+        };
+
+        /**
+         * @brief A read-only view of a whole file that is mapped into memory, so reading it doesn't copy anything.
+         * @note   The file is unmapped when the object is destroyed. Views and spans taken from it don't outlive it.
+         *         Pages are read when they are touched, so if another process truncates the file meanwhile, touching a page past the new end raises SIGBUS(an access violation on Windows) and kills the process.
+         *         Don't map files that can shrink while they are read, like logs rotated with copytruncate. read_file, count_lines, hash_file and lines read with system calls and are safe for those.
+         */
+        class mapped_file final {
+        public:
+            /**
+             * @brief Constructs a closed file.
+             * @note
+             */
+            mapped_file(void) noexcept = default;
+
+            /**
+             * @brief Opens and maps a file.
+             * @note   Only regular files can be mapped. Check is_open() afterwards. An empty file opens with an empty view.
+             * @param  path: The path for the specified file
+             * @param  hint: How the file is going to be read
+             */
+            explicit mapped_file(const std::string& path, const access_hint hint = access_hint::sequential) noexcept {
+                open(path, hint);
+            }
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            mapped_file(mapped_file&& other) noexcept
+                : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)), m_open(std::exchange(other.m_open, false)) {}
+
+            mapped_file& operator=(mapped_file&& other) noexcept {
+                if(this != &other) [[likely]] {
+                    close();
+                    m_data = std::exchange(other.m_data, nullptr);
+                    m_size = std::exchange(other.m_size, 0);
+                    m_open = std::exchange(other.m_open, false);
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Opens and maps a file, closing the one that was open.
+             * @note
+             * @param  path: The path for the specified file
+             * @param  hint: How the file is going to be read
+             * @retval True if mapped correctly
+             */
+            bool open(const std::string& path, const access_hint hint = access_hint::sequential) noexcept {
+                close();
+#ifdef XENON_M_WIN
+                const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if(file == INVALID_HANDLE_VALUE) [[unlikely]]
+                    return false;
+                LARGE_INTEGER size;
+                if(GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size)) [[unlikely]] {
+                    CloseHandle(file);
+                    return false;
+                }
+                m_size = static_cast<size_t>(size.QuadPart);
+                if(m_size > 0) [[likely]] {
+                    // The view keeps the mapping alive, so both handles can go right away
+                    const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    if(mapping != nullptr) [[likely]] {
+                        m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                        CloseHandle(mapping);
+                    }
+                    if(m_data == nullptr) [[unlikely]] {
+                        CloseHandle(file);
+                        m_size = 0;
+                        return false;
+                    }
+                }
+                CloseHandle(file);
+#else
+                const int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if(file == -1) [[unlikely]]
+                    return false;
+                struct stat info;
+                if(fstat(file, &info) != 0 || !S_ISREG(info.st_mode)) [[unlikely]] {
+                    ::close(file);
+                    return false;
+                }
+                m_size = static_cast<size_t>(info.st_size);
+                if(m_size > 0) [[likely]] {
+                    // The mapping holds its own reference, so the descriptor can go right away
+                    void* const data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+                    if(data == MAP_FAILED) [[unlikely]] {
+                        ::close(file);
+                        m_size = 0;
+                        return false;
+                    }
+                    m_data = data;
+                }
+                ::close(file);
+#endif // XENON_M_WIN
+                m_open = true;
+                advise(hint);
+                return true;
+            }
+
+            /**
+             * @brief Unmaps the file.
+             * @note   Does nothing if it's not open.
+             * @retval None
+             */
+            void close(void) noexcept {
+                if(m_data != nullptr) {
+#ifdef XENON_M_WIN
+                    UnmapViewOfFile(m_data);
+#else
+                    munmap(m_data, m_size);
+#endif // XENON_M_WIN
+                }
+                m_data = nullptr;
+                m_size = 0;
+                m_open = false;
+            }
+
+            /**
+             * @brief Tells the OS how the file is going to be read from now on.
+             * @note   Can be called as many times as needed, e.g. willneed right before a scan.
+             * @param  hint: How the file is going to be read
+             * @retval True if the OS took the hint
+             */
+            bool advise(const access_hint hint) noexcept {
+                if(m_data == nullptr) [[unlikely]]
+                    return false;
+#ifdef XENON_M_WIN
+                if(hint == access_hint::willneed) {
+                    WIN32_MEMORY_RANGE_ENTRY range = { m_data, m_size };
+                    return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+                }
+                return hint == access_hint::normal;
+#else
+                int advice = MADV_NORMAL;
+                switch(hint) {
+                case access_hint::normal:
+                    break;
+                case access_hint::sequential:
+                    advice = MADV_SEQUENTIAL;
+                    break;
+                case access_hint::random:
+                    advice = MADV_RANDOM;
+                    break;
+                case access_hint::willneed:
+                    advice = MADV_WILLNEED;
+                    break;
+                case access_hint::hugepage:
+#ifdef MADV_HUGEPAGE
+                    advice = MADV_HUGEPAGE;
+                    break;
+#else
+                    return false;
+#endif // MADV_HUGEPAGE
+                }
+                return madvise(m_data, m_size, advice) == 0;
+#endif // XENON_M_WIN
+            }
+
+            /**
+             * @brief Checks whether the file is mapped.
+             * @note
+             * @retval True if open
+             */
+            [[nodiscard]] bool is_open(void) const noexcept {
+                return m_open;
+            }
+
+            explicit operator bool(void) const noexcept {
+                return m_open;
+            }
+
+            /**
+             * @brief Gets the size of the file.
+             * @note
+             * @retval Size in bytes
+             */
+            [[nodiscard]] size_t size(void) const noexcept {
+                return m_size;
+            }
+
+            /**
+             * @brief Gets the start of the mapped contents.
+             * @note   Null if the file is empty or not open.
+             * @retval Pointer to the first character
+             */
+            [[nodiscard]] const char* data(void) const noexcept {
+                return static_cast<const char*>(m_data);
+            }
+
+            /**
+             * @brief Gets the contents as bytes.
+             * @note
+             * @retval A span over the whole file
+             */
+            [[nodiscard]] std::span<const std::byte> bytes(void) const noexcept {
+                return { static_cast<const std::byte*>(m_data), m_size };
+            }
+
+            /**
+             * @brief Gets the contents as text.
+             * @note
+             * @retval A view of the whole file
+             */
+            [[nodiscard]] std::string_view view(void) const noexcept {
+                return { data(), m_size };
+            }
+
+            ~mapped_file(void) noexcept {
+                close();
+            }
+        private:
+            void* m_data = nullptr;
+            size_t m_size = 0;
+            bool m_open = false;
+        };
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_MAPPED_FILE
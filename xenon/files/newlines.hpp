@@ -0,0 +1,178 @@
+// newlines.hpp
+//
+// Newline counting that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_NEWLINES
+#define XENON_HG_FILES_NEWLINES
+
+// Libraries
+#include <span>
+#include <string_view>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// Xenon's Modules
+#include "../macros.hpp"
+#include "../utilities/parts/cpu.hpp"
+#include "../async/parallel.hpp"
+
+#ifdef XENON_M_X86
+#include <immintrin.h>
+#endif // XENON_M_X86
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    enum class XENON_HF_newline_simd {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    inline XENON_HF_newline_simd XENON_HF_newline_simd_level(void) noexcept {
+#ifdef XENON_M_X86
+        const xenon::utilities::cpu_features& features = xenon::utilities::cpu();
+        return features.avx512bw ? XENON_HF_newline_simd::avx512 : features.avx2 ? XENON_HF_newline_simd::avx2 : XENON_HF_newline_simd::sse2;
+#else
+        return XENON_HF_newline_simd::scalar;
+#endif // XENON_M_X86
+    }
+
+    /**
+     * @brief Counts 8 bytes at a time: a byte of x ^ '\n' is zero exactly where there is a newline.
+     */
+    inline uint64_t XENON_HF_count_newlines_scalar(const char* data, const size_t size) noexcept {
+        constexpr uint64_t ones = 0x0101010101010101, high = 0x8080808080808080, low = 0x7F7F7F7F7F7F7F7F;
+        uint64_t count = 0;
+        size_t i = 0;
+        for(; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            word ^= ones * '\n';
+            // The high bit of a byte is set only if the byte is zero, without carries between bytes
+            count += static_cast<uint64_t>(std::popcount(~(((word & low) + low) | word) & high));
+        }
+        for(; i < size; ++i)
+            count += data[i] == '\n';
+        return count;
+    }
+
+#ifdef XENON_M_X86
+    /**
+     * @brief Subtracts the compare masks(-1 per match) from byte counters and folds them with sad before any of them can overflow.
+     */
+    XENON_M_TARGET("sse2") inline uint64_t XENON_HF_count_newlines_sse2(const char* data, const size_t size) noexcept {
+        const __m128i newline = _mm_set1_epi8('\n');
+        __m128i total = _mm_setzero_si128();
+        size_t i = 0;
+        while(i + 16 <= size) {
+            __m128i counters = _mm_setzero_si128();
+            for(size_t steps = 0; steps < 255 && i + 16 <= size; ++steps, i += 16)
+                counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), newline));
+            total = _mm_add_epi64(total, _mm_sad_epu8(counters, _mm_setzero_si128()));
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), total);
+        return lanes[0] + lanes[1] + XENON_HF_count_newlines_scalar(data + i, size - i);
+    }
+
+    XENON_M_TARGET("avx2") inline uint64_t XENON_HF_count_newlines_avx2(const char* data, const size_t size) noexcept {
+        const __m256i newline = _mm256_set1_epi8('\n');
+        __m256i total = _mm256_setzero_si256();
+        size_t i = 0;
+        while(i + 64 <= size) {
+            // Two independent counters per iteration keep both load ports busy
+            __m256i first = _mm256_setzero_si256(), second = _mm256_setzero_si256();
+            for(size_t steps = 0; steps < 255 && i + 64 <= size; ++steps, i += 64) {
+                first = _mm256_sub_epi8(first, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), newline));
+                second = _mm256_sub_epi8(second, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32)), newline));
+            }
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(first, _mm256_setzero_si256()));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(second, _mm256_setzero_si256()));
+        }
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + XENON_HF_count_newlines_scalar(data + i, size - i);
+    }
+
+    XENON_M_TARGET("avx512f,avx512bw,popcnt") inline uint64_t XENON_HF_count_newlines_avx512(const char* data, const size_t size) noexcept {
+        const __m512i newline = _mm512_set1_epi8('\n');
+        uint64_t first = 0, second = 0;
+        size_t i = 0;
+        for(; i + 128 <= size; i += 128) {
+            first += static_cast<uint64_t>(std::popcount(static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i), newline))));
+            second += static_cast<uint64_t>(std::popcount(static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i + 64), newline))));
+        }
+        if(i < size) {
+            // The tail is loaded with a mask, so it never reads past the end
+            const size_t left = size - i;
+            if(left >= 64) {
+                first += static_cast<uint64_t>(std::popcount(static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i), newline))));
+                i += 64;
+            }
+            const __mmask64 mask = (uint64_t(1) << (size - i)) - 1;
+            second += static_cast<uint64_t>(std::popcount(static_cast<uint64_t>(_mm512_mask_cmpeq_epi8_mask(mask, _mm512_maskz_loadu_epi8(mask, data + i), newline))));
+        }
+        return first + second;
+    }
+#endif // XENON_M_X86
+
+    inline uint64_t XENON_HF_count_newlines(const XENON_HF_newline_simd simd, const char* data, const size_t size) noexcept {
+#ifdef XENON_M_X86
+        if(simd == XENON_HF_newline_simd::avx512)
+            return XENON_HF_count_newlines_avx512(data, size);
+        if(simd == XENON_HF_newline_simd::avx2)
+            return XENON_HF_count_newlines_avx2(data, size);
+        if(simd == XENON_HF_newline_simd::sse2)
+            return XENON_HF_count_newlines_sse2(data, size);
+#endif // XENON_M_X86
+        return XENON_HF_count_newlines_scalar(data, size);
+    }
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Buffers at least this big are counted on several threads.
+         * @note   Below it, waking the workers costs more than it saves.
+         */
+        inline constexpr size_t parallel_count_threshold = size_t(64) << 20;
+
+        /**
+         * @brief Counts the '\n' characters in a buffer.
+         * @note   Uses AVX-512, AVX2 or SSE2, whichever the CPU has. Buffers of parallel_count_threshold bytes and more are split into chunks across the pool.
+         * @param  text: The buffer
+         * @param  pool: The pool to count on
+         * @retval Number of newlines
+         */
+        [[nodiscard]] inline uint64_t count_newlines(const std::string_view text, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            static const XENON_HF_newline_simd simd = XENON_HF_newline_simd_level();
+            if(text.size() < parallel_count_threshold || pool.size() == 1) [[likely]]
+                return XENON_HF_count_newlines(simd, text.data(), text.size());
+
+            // Chunks of a few megabytes are big enough to stream and small enough to balance out
+            std::atomic<uint64_t> count = 0;
+            XENON_HF_parallel_chunks(text.size(), size_t(4) << 20, pool, [&](const size_t begin, const size_t end) {
+                count.fetch_add(XENON_HF_count_newlines(simd, text.data() + begin, end - begin), std::memory_order_relaxed);
+            });
+            return count.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Counts the '\n' bytes in a buffer.
+         * @note   Same as the string_view overload.
+         * @param  bytes: The buffer
+         * @param  pool: The pool to count on
+         * @retval Number of newlines
+         */
+        [[nodiscard]] inline uint64_t count_newlines(const std::span<const std::byte> bytes, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            return count_newlines(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()), pool);
+        }
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_NEWLINES
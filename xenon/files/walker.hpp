@@ -0,0 +1,291 @@
+// walker.hpp
+//
+// A parallel directory walker that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_WALKER
+#define XENON_HG_FILES_WALKER
+
+#include "../macros.hpp"
+
+// Libraries
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef XENON_M_LINUX
+#include <sys/syscall.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // XENON_M_LINUX
+
+// Xenon's Modules
+#include "../async/thread_pool.hpp"
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief What a directory entry is.
+         * @note   Symlinks are reported as symlinks and never followed.
+         */
+        enum class entry_type {
+            unknown,
+            file,
+            directory,
+            symlink,
+            other
+        };
+
+        /**
+         * @brief An entry the walker found.
+         * @note   The views are only valid during the callback.
+         */
+        struct walk_entry {
+            // The root joined with the entry's relative path
+            std::string_view path;
+            std::string_view name;
+            entry_type type;
+            // 0 for the entries right inside the root
+            uint32_t depth;
+        };
+
+        /**
+         * @brief Filters that the walker applies while walking, so that skipped subtrees are never read.
+         * @note   Globs match an entry's name and support * and ?.
+         */
+        struct walk_options {
+            // Directories deeper than this aren't entered. 0 only lists the root
+            uint32_t max_depth = std::numeric_limits<uint32_t>::max();
+            // If not empty, only files and symlinks whose name matches one of these are reported. Directories are always entered
+            std::vector<std::string> include;
+            // Entries whose name matches one of these are skipped, and directories aren't entered
+            std::vector<std::string> exclude;
+        };
+    } // namespace files
+} // namespace xenon
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    /**
+     * @brief Matches * and ? with backtracking to the last star only, which is linear for patterns without several stars in a row.
+     */
+    inline bool XENON_HF_glob_match(const std::string_view pattern, const std::string_view text) noexcept {
+        size_t p = 0, t = 0, star = std::string_view::npos, resume = 0;
+        while(t < text.size()) {
+            if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+                ++p;
+                ++t;
+            } else if(p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                resume = t;
+            } else if(star != std::string_view::npos) {
+                p = star + 1;
+                t = ++resume;
+            } else
+                return false;
+        }
+        while(p < pattern.size() && pattern[p] == '*')
+            ++p;
+        return p == pattern.size();
+    }
+
+    inline bool XENON_HF_glob_any(const std::vector<std::string>& patterns, const std::string_view name) noexcept {
+        for(const std::string& pattern : patterns)
+            if(XENON_HF_glob_match(pattern, name))
+                return true;
+        return false;
+    }
+
+#ifdef XENON_M_LINUX
+    struct XENON_HF_dirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    inline xenon::files::entry_type XENON_HF_entry_type(const unsigned char type) noexcept {
+        switch(type) {
+        case DT_REG:
+            return xenon::files::entry_type::file;
+        case DT_DIR:
+            return xenon::files::entry_type::directory;
+        case DT_LNK:
+            return xenon::files::entry_type::symlink;
+        case DT_UNKNOWN:
+            return xenon::files::entry_type::unknown;
+        default:
+            return xenon::files::entry_type::other;
+        }
+    }
+#endif // XENON_M_LINUX
+
+    /**
+     * @brief Calls entry_func(name, type) for every entry of a directory except . and ..
+     * @note   On Linux it's getdents64 with a big buffer, and the type comes from d_type. Only the file systems that don't fill d_type cost a stat.
+     */
+    template<typename F>
+    inline void XENON_HF_list_directory(const std::string& path, F&& entry_func) noexcept {
+#ifdef XENON_M_LINUX
+        const int directory = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(directory < 0) [[unlikely]]
+            return;
+        constexpr size_t buffer_size = size_t(256) << 10;
+        // One buffer per thread, unless the callback lists another directory while this one is being listed
+        thread_local std::unique_ptr<char[]> cached(new char[buffer_size]);
+        std::unique_ptr<char[]> buffer = cached != nullptr ? std::move(cached) : std::unique_ptr<char[]>(new char[buffer_size]);
+        for(;;) {
+            const long read = syscall(SYS_getdents64, directory, buffer.get(), buffer_size);
+            if(read <= 0)
+                break;
+            for(long offset = 0; offset < read;) {
+                const XENON_HF_dirent64* const entry = reinterpret_cast<const XENON_HF_dirent64*>(buffer.get() + offset);
+                offset += entry->d_reclen;
+                const std::string_view name(entry->d_name);
+                if(name == "." || name == "..")
+                    continue;
+                xenon::files::entry_type type = XENON_HF_entry_type(entry->d_type);
+                if(type == xenon::files::entry_type::unknown) [[unlikely]] {
+                    struct stat info;
+                    if(fstatat(directory, entry->d_name, &info, AT_SYMLINK_NOFOLLOW) == 0)
+                        type = S_ISREG(info.st_mode) ? xenon::files::entry_type::file : S_ISDIR(info.st_mode) ? xenon::files::entry_type::directory : S_ISLNK(info.st_mode) ? xenon::files::entry_type::symlink : xenon::files::entry_type::other;
+                }
+                entry_func(name, type);
+            }
+        }
+        close(directory);
+        cached = std::move(buffer);
+#else
+        std::error_code error;
+        for(std::filesystem::directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+            // The type is cached from the directory listing on Windows, so this doesn't stat
+            const std::filesystem::file_status status = it->symlink_status(error);
+            const xenon::files::entry_type type = error ? xenon::files::entry_type::unknown : std::filesystem::is_symlink(status) ? xenon::files::entry_type::symlink : std::filesystem::is_directory(status) ? xenon::files::entry_type::directory : std::filesystem::is_regular_file(status) ? xenon::files::entry_type::file : xenon::files::entry_type::other;
+            const std::string name = it->path().filename().string();
+            entry_func(std::string_view(name), type);
+        }
+#endif // XENON_M_LINUX
+    }
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Walks a directory tree, reading several directories at once on the pool.
+         * @note   The callback is called from pool threads and the calling thread at the same time and in no particular order, so it has to be thread-safe.
+         *         Every directory is a job of its own that never blocks, and only the calling thread waits, reading directories itself meanwhile. So it's safe to call from a pool task.
+         *         Directories that can't be read are skipped. Symlinks to directories are reported but not entered.
+         * @param  path: The path to the specified directory
+         * @param  callback_func: A function that accepts const walk_entry&
+         * @param  options: Depth and glob filters
+         * @param  pool: The pool to walk on. The calling thread walks too
+         * @retval None
+         */
+        template<typename F>
+            requires requires(F&& func, const walk_entry& entry) {
+                func(entry);
+            }
+        inline void walk(const std::string& path, F&& callback_func, const walk_options& options = {}, xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept {
+            struct directory {
+                std::string path;
+                uint32_t depth;
+            };
+
+            struct shared {
+                std::mutex mutex;
+                std::vector<directory> stack;
+                // Directories that are queued or being read. It grows under the mutex together with the stack, so the caller can wait on it
+                std::atomic<size_t> pending = 0;
+                std::remove_reference_t<F>* callback_func;
+                const walk_options* options;
+                xenon::async::thread_pool* pool;
+
+                /**
+                 * @brief Reads one queued directory and submits a job for every directory in it. False if the stack was empty.
+                 */
+                static bool step(const std::shared_ptr<shared>& state) noexcept {
+                    shared& walk = *state;
+                    directory current;
+                    {
+                        std::lock_guard<std::mutex> lock(walk.mutex);
+                        if(walk.stack.empty())
+                            return false;
+                        current = std::move(walk.stack.back());
+                        walk.stack.pop_back();
+                    }
+
+                    // The path is built in one reused string, so reporting an entry doesn't allocate
+                    std::string entry_path = current.path;
+                    if(!entry_path.empty() && entry_path.back() != '/')
+                        entry_path += '/';
+                    const size_t prefix = entry_path.size();
+                    std::vector<directory> found;
+                    XENON_HF_list_directory(current.path, [&](const std::string_view name, const entry_type type) {
+                        if(!walk.options->exclude.empty() && XENON_HF_glob_any(walk.options->exclude, name))
+                            return;
+                        entry_path.resize(prefix);
+                        entry_path += name;
+                        if(type == entry_type::directory) {
+                            if(current.depth < walk.options->max_depth)
+                                found.push_back({ entry_path, current.depth + 1 });
+                        } else if(!walk.options->include.empty() && !XENON_HF_glob_any(walk.options->include, name))
+                            return;
+                        (*walk.callback_func)(walk_entry{ entry_path, std::string_view(entry_path).substr(prefix), type, current.depth });
+                    });
+
+                    if(!found.empty()) {
+                        const size_t count = found.size();
+                        {
+                            std::lock_guard<std::mutex> lock(walk.mutex);
+                            for(directory& next : found)
+                                walk.stack.push_back(std::move(next));
+                            walk.pending.fetch_add(count, std::memory_order_relaxed);
+                        }
+                        walk.pending.notify_all();
+                        // A job may find the stack empty if the caller got there first, and then just returns
+                        for(size_t i = 0; i < count; ++i)
+                            walk.pool->submit([state]() { step(state); });
+                    }
+                    // Nothing but the shared_ptr is touched after the last directory is done, the callback may be gone
+                    if(walk.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        walk.pending.notify_all();
+                    return true;
+                }
+            };
+
+            std::shared_ptr<shared> state = std::make_shared<shared>();
+            state->stack.push_back({ path, 0 });
+            state->pending.store(1, std::memory_order_relaxed);
+            state->callback_func = &callback_func;
+            state->options = &options;
+            state->pool = &pool;
+
+            for(;;) {
+                if(shared::step(state))
+                    continue;
+                size_t pending = 0;
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if(!state->stack.empty())
+                        continue;
+                    pending = state->pending.load(std::memory_order_acquire);
+                }
+                if(pending == 0)
+                    return;
+                state->pending.wait(pending, std::memory_order_acquire);
+            }
+        }
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_WALKER
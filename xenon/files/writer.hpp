@@ -0,0 +1,590 @@
+// writer.hpp
+//
+// A buffered file writer class that is a part of a Files module.
+
+#ifndef XENON_HG_FILES_WRITER
+#define XENON_HG_FILES_WRITER
+
+#include "../macros.hpp"
+
+// Libraries
+#include <ios>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef XENON_M_WIN
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#else
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+#endif // XENON_M_WIN
+
+// Xenon's Modules
+#include "../bench/profiler.hpp"
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+#ifdef XENON_M_WIN
+    using XENON_HF_file_handle = HANDLE;
+    inline const XENON_HF_file_handle XENON_HF_no_file = INVALID_HANDLE_VALUE;
+#else
+    using XENON_HF_file_handle = int;
+    inline constexpr XENON_HF_file_handle XENON_HF_no_file = -1;
+#endif // XENON_M_WIN
+
+    /**
+     * @brief Writes all the pieces in as few calls as possible, resuming after partial writes.
+     * @note   One writev per IOV_MAX pieces on POSIX. Windows has no gather write for ordinary files, so it's one WriteFile per piece.
+     *         append only matters on Windows, where the handle has GENERIC_WRITE(FlushFileBuffers needs it) and every write goes to the end through the 0xFFFFFFFF offset. POSIX files are opened with O_APPEND instead.
+     */
+    inline bool XENON_HF_write_pieces(const XENON_HF_file_handle file, std::string_view* pieces, size_t count, [[maybe_unused]] const bool append = false) noexcept {
+#ifdef XENON_M_WIN
+        for(size_t i = 0; i < count; ++i) {
+            for(std::string_view piece = pieces[i]; !piece.empty();) {
+                DWORD written = 0;
+                OVERLAPPED end = {};
+                end.Offset = end.OffsetHigh = 0xFFFFFFFF;
+                if(!WriteFile(file, piece.data(), static_cast<DWORD>(std::min<size_t>(piece.size(), 1u << 30)), &written, append ? &end : nullptr)) [[unlikely]]
+                    return false;
+                piece.remove_prefix(written);
+            }
+        }
+        return true;
+#else
+        constexpr size_t batch = IOV_MAX < 1024 ? IOV_MAX : 1024;
+        iovec vectors[batch];
+        while(count > 0) {
+            const size_t used = std::min(count, batch);
+            for(size_t i = 0; i < used; ++i)
+                vectors[i] = { const_cast<char*>(pieces[i].data()), pieces[i].size() };
+            const ssize_t written = writev(file, vectors, static_cast<int>(used));
+            if(written < 0) [[unlikely]] {
+                if(errno == EINTR)
+                    continue;
+                return false;
+            }
+            // Drops the pieces that went out whole and trims the one that went out partly
+            size_t left = static_cast<size_t>(written);
+            while(count > 0 && left >= pieces->size()) {
+                left -= pieces->size();
+                ++pieces;
+                --count;
+            }
+            if(count > 0)
+                pieces->remove_prefix(left);
+        }
+        return true;
+#endif // XENON_M_WIN
+    }
+
+    inline void XENON_HF_remove_file(const std::string& path) noexcept {
+#ifdef XENON_M_WIN
+        DeleteFileA(path.c_str());
+#else
+        unlink(path.c_str());
+#endif // XENON_M_WIN
+    }
+
+    inline bool XENON_HF_sync_file(const XENON_HF_file_handle file) noexcept {
+#ifdef XENON_M_WIN
+        return FlushFileBuffers(file);
+#elif defined(__APPLE__)
+        return fsync(file) == 0;
+#else
+        return fdatasync(file) == 0;
+#endif // XENON_M_WIN
+    }
+
+    /**
+     * @brief A name next to the target, so renaming it over the target never crosses file systems. Unique within the machine.
+     */
+    inline std::string XENON_HF_temporary_path(const std::string& target) noexcept {
+        static std::atomic<uint64_t> counter = 0;
+#ifdef XENON_M_WIN
+        const unsigned long process = GetCurrentProcessId();
+#else
+        const unsigned long process = static_cast<unsigned long>(getpid());
+#endif // XENON_M_WIN
+        return target + ".xenon-" + std::to_string(process) + '-' + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    }
+
+    /**
+     * @brief A finished temporary file that waits to replace its target.
+     */
+    struct XENON_HF_pending_commit {
+        XENON_HF_file_handle file;
+        const std::string* temporary;
+        const std::string* target;
+        bool done = false;
+        bool result = false;
+    };
+
+    /**
+     * @brief Group commit: every writer syncs its own file, then the first one to queue renames and syncs the directories for everyone that queued up meanwhile, and the rest only wait.
+     * @note   A lone writer doesn't wait for anybody. The data syncs run on the writers' own threads, so they overlap. Under load one batch costs one directory sync per directory instead of one per file.
+     */
+    class XENON_HF_group_commit final {
+    public:
+        static XENON_HF_group_commit& instance(void) noexcept {
+            // Leaked on purpose, so writers closed during static destruction still have it
+            static XENON_HF_group_commit* committer = new XENON_HF_group_commit();
+            return *committer;
+        }
+
+        /**
+         * @brief Syncs and closes the file, then renames it over the target. The temporary file is removed if anything fails.
+         */
+        bool commit(XENON_HF_pending_commit& pending) noexcept {
+            // Outside the lock, so writers that close at the same time sync at the same time
+            pending.result = XENON_HF_sync_file(pending.file);
+#ifdef XENON_M_WIN
+            CloseHandle(pending.file);
+#else
+            ::close(pending.file);
+#endif // XENON_M_WIN
+            if(!pending.result) [[unlikely]] {
+                XENON_HF_remove_file(*pending.temporary);
+                return false;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queue.push_back(&pending);
+            while(!pending.done) {
+                if(m_leading) {
+                    m_wakeup.wait(lock);
+                    continue;
+                }
+                m_leading = true;
+                std::vector<XENON_HF_pending_commit*> batch;
+                batch.swap(m_queue);
+                lock.unlock();
+                run(batch);
+                lock.lock();
+                for(XENON_HF_pending_commit* const finished : batch)
+                    finished->done = true;
+                m_leading = false;
+                m_wakeup.notify_all();
+            }
+            return pending.result;
+        }
+    private:
+        static void run(const std::vector<XENON_HF_pending_commit*>& batch) noexcept {
+            XENON_PROFILE_ZONE("xenon::files::group_commit");
+#ifdef XENON_M_WIN
+            for(XENON_HF_pending_commit* const pending : batch) {
+                pending->result = MoveFileExA(pending->temporary->c_str(), pending->target->c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+                if(!pending->result) [[unlikely]]
+                    DeleteFileA(pending->temporary->c_str());
+            }
+#else
+            // The files are synced already, so the batch is only renames and one sync per directory
+            std::vector<std::string> directories;
+            for(XENON_HF_pending_commit* const pending : batch) {
+                pending->result = rename(pending->temporary->c_str(), pending->target->c_str()) == 0;
+                if(!pending->result) [[unlikely]]
+                    unlink(pending->temporary->c_str());
+                else
+                    directories.push_back(parent(*pending->target));
+            }
+
+            // The rename is only durable once the directory that holds it is synced
+            std::sort(directories.begin(), directories.end());
+            directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
+            for(const std::string& directory : directories) {
+                const int file = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if(file >= 0 && fsync(file) == 0) [[likely]] {
+                    ::close(file);
+                    continue;
+                }
+                if(file >= 0)
+                    ::close(file);
+                for(XENON_HF_pending_commit* const pending : batch)
+                    if(pending->result && parent(*pending->target) == directory)
+                        pending->result = false;
+            }
+#endif // XENON_M_WIN
+        }
+
+        static std::string parent(const std::string& path) noexcept {
+            const size_t slash = path.find_last_of('/');
+            return slash == std::string::npos ? std::string(".") : slash == 0 ? std::string("/") : path.substr(0, slash);
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_wakeup;
+        std::vector<XENON_HF_pending_commit*> m_queue;
+        bool m_leading = false;
+    };
+}
+
+namespace xenon {
+    namespace files {
+        /**
+         * @brief Writing mode that can be used when writing to files.
+         * @note
+         */
+        enum class writing_mode {
+            overwrite = std::ios_base::in | std::ios_base::out,
+            append = std::ios_base::app,
+            // Writes a temporary file next to the target and renames it over the target once it's synced, so a crash leaves either the old file or the new one
+            atomic = std::ios_base::out | std::ios_base::trunc
+        };
+
+        /**
+         * @brief How far data has to get before a flush returns.
+         * @note
+         */
+        enum class durability {
+            // The OS page cache, which is lost if the machine crashes
+            none,
+            // The storage device: every flush ends with fdatasync(FlushFileBuffers on Windows)
+            data_sync,
+            // Same as data_sync, but the page cache is bypassed with O_DIRECT(write-through on Windows), so huge logs don't evict everything else
+            direct
+        };
+
+        /**
+         * @brief Keeps a file open and collects writes in a big buffer, so that many small writes turn into one system call.
+         * @note   Thread-safe. Pieces that don't fit in the buffer go straight to the file, gathered with the buffer into one writev.
+         *         Everything is flushed when the writer is closed or destroyed. An atomic writer replaces the target only then, and concurrent atomic writers share their syncs.
+         */
+        class writer final {
+        public:
+            /**
+             * @brief Default size of the buffer.
+             * @note
+             */
+            static constexpr size_t default_buffer_size = size_t(1) << 20;
+
+            /**
+             * @brief Blocks that direct writes are aligned to.
+             * @note
+             */
+            static constexpr size_t direct_alignment = 4096;
+
+            /**
+             * @brief Constructs a closed writer.
+             * @note
+             */
+            writer(void) noexcept = default;
+
+            /**
+             * @brief Opens a file for writing.
+             * @note   Check is_open() afterwards.
+             * @param  path: The path for the specified file
+             * @param  open_mode: overwrite truncates the file, append writes after its end, atomic replaces the file when the writer is closed. Each creates the file
+             * @param  level: How far data has to get before a flush returns
+             * @param  buffer_size: Size of the buffer
+             * @param  flush_interval: How often a background thread flushes the buffer. 0 for no thread
+             */
+            explicit writer(const std::string& path, const writing_mode open_mode = writing_mode::append, const durability level = durability::none, const size_t buffer_size = default_buffer_size, const std::chrono::milliseconds flush_interval = std::chrono::milliseconds(0)) noexcept {
+                open(path, open_mode, level, buffer_size, flush_interval);
+            }
+
+            writer(const writer&) = delete;
+            writer& operator=(const writer&) = delete;
+
+            /**
+             * @brief Opens a file for writing, closing the one that was open.
+             * @note   direct falls back to data_sync where the file system doesn't support it, or when appending to a file that doesn't end on a block boundary.
+             * @param  path: The path for the specified file
+             * @param  open_mode: overwrite truncates the file, append writes after its end, atomic replaces the file when the writer is closed. Each creates the file
+             * @param  level: How far data has to get before a flush returns
+             * @param  buffer_size: Size of the buffer
+             * @param  flush_interval: How often a background thread flushes the buffer. 0 for no thread
+             * @retval True if opened correctly
+             */
+            bool open(const std::string& path, const writing_mode open_mode = writing_mode::append, const durability level = durability::none, const size_t buffer_size = default_buffer_size, const std::chrono::milliseconds flush_interval = std::chrono::milliseconds(0)) noexcept {
+                close();
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_level = level;
+                m_direct = false;
+                m_atomic = open_mode == writing_mode::atomic;
+                m_append = open_mode == writing_mode::append;
+                m_target = m_atomic ? path : std::string();
+                m_temporary = m_atomic ? XENON_HF_temporary_path(path) : std::string();
+                const std::string& opened = m_atomic ? m_temporary : path;
+#ifdef XENON_M_WIN
+                const DWORD flags = FILE_ATTRIBUTE_NORMAL | (level == durability::direct ? FILE_FLAG_WRITE_THROUGH : 0);
+                m_file = CreateFileA(opened.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, open_mode == writing_mode::append ? OPEN_ALWAYS : m_atomic ? CREATE_NEW : CREATE_ALWAYS, flags, nullptr);
+#else
+                const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (open_mode == writing_mode::append ? O_APPEND : m_atomic ? O_EXCL : O_TRUNC);
+                // The replacement keeps the permissions of the file it replaces
+                struct stat target;
+                const mode_t permissions = m_atomic && stat(path.c_str(), &target) == 0 ? (target.st_mode & 07777) : 0644;
+#ifdef O_DIRECT
+                if(level == durability::direct) {
+                    m_file = ::open(opened.c_str(), flags | O_DIRECT, permissions);
+                    m_direct = m_file != XENON_HF_no_file;
+                    // Direct writes have to start on a block boundary
+                    if(m_direct && lseek(m_file, 0, SEEK_END) % static_cast<off_t>(direct_alignment) != 0) {
+                        fcntl(m_file, F_SETFL, fcntl(m_file, F_GETFL) & ~O_DIRECT);
+                        m_direct = false;
+                    }
+                }
+#endif // O_DIRECT
+                if(m_file == XENON_HF_no_file)
+                    m_file = ::open(opened.c_str(), flags, permissions);
+                if(m_atomic && m_file != XENON_HF_no_file && permissions != 0644)
+                    fchmod(m_file, permissions);
+#endif // XENON_M_WIN
+                if(m_file == XENON_HF_no_file) [[unlikely]]
+                    return false;
+
+                // Direct writes also need the memory and the size aligned
+                m_capacity = (std::max<size_t>(buffer_size, direct_alignment) + direct_alignment - 1) / direct_alignment * direct_alignment;
+                m_buffer = static_cast<char*>(::operator new(m_capacity, std::align_val_t(direct_alignment), std::nothrow));
+                if(m_buffer == nullptr) [[unlikely]] {
+                    close_file();
+                    return false;
+                }
+                m_size = 0;
+                m_good = true;
+                m_unsynced = false;
+                if(flush_interval.count() > 0) {
+                    m_stopping = false;
+                    m_flusher = std::thread([this, flush_interval]() {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        while(!m_stopping) {
+                            m_wakeup.wait_for(lock, flush_interval, [this]() { return m_stopping; });
+                            if(m_size > 0)
+                                flush_buffer(false);
+                        }
+                    });
+                }
+                return true;
+            }
+
+            /**
+             * @brief Writes text.
+             * @note   Only copies into the buffer unless it's full.
+             * @param  text: The text
+             * @retval False if the writer isn't open or writing failed
+             */
+            bool write(const std::string_view text) noexcept {
+                return write(std::span<const std::string_view>(&text, 1));
+            }
+
+            /**
+             * @brief Writes text followed by a newline.
+             * @note
+             * @param  line: The line without a newline
+             * @retval False if the writer isn't open or writing failed
+             */
+            bool write_line(const std::string_view line) noexcept {
+                const std::string_view pieces[2] = { line, "\n" };
+                return write(std::span<const std::string_view>(pieces));
+            }
+
+            /**
+             * @brief Writes several pieces one after another.
+             * @note   Pieces that don't fit in the buffer are written together with it in one writev, without being copied.
+             * @param  pieces: The pieces
+             * @retval False if the writer isn't open or writing failed
+             */
+            bool write(const std::span<const std::string_view> pieces) noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(!m_good) [[unlikely]]
+                    return false;
+                size_t total = 0;
+                for(const std::string_view piece : pieces)
+                    total += piece.size();
+                if(total <= m_capacity - m_size || m_direct) [[likely]] {
+                    // Direct writes can only leave from the aligned buffer, so they are always copied
+                    for(std::string_view piece : pieces) {
+                        while(!piece.empty()) {
+                            const size_t copied = std::min(piece.size(), m_capacity - m_size);
+                            std::memcpy(m_buffer + m_size, piece.data(), copied);
+                            m_size += copied;
+                            piece.remove_prefix(copied);
+                            if(m_size == m_capacity && !flush_buffer(false)) [[unlikely]]
+                                return false;
+                        }
+                    }
+                    return true;
+                }
+
+                std::vector<std::string_view> gathered;
+                gathered.reserve(pieces.size() + 1);
+                gathered.emplace_back(m_buffer, m_size);
+                gathered.insert(gathered.end(), pieces.begin(), pieces.end());
+                m_size = 0;
+                m_good = XENON_HF_write_pieces(m_file, gathered.data(), gathered.size(), m_append);
+                m_unsynced = true;
+                return m_good;
+            }
+
+            /**
+             * @brief Writes the buffer out and waits for the durability level.
+             * @note   With direct the last partial block stays buffered until the writer is closed, because direct writes have to be whole blocks.
+             * @retval False if the writer isn't open or writing failed
+             */
+            bool flush(void) noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_good && flush_buffer(false);
+            }
+
+            /**
+             * @brief Flushes everything and closes the file.
+             * @note   Does nothing if it's not open. An atomic writer syncs the file and renames it over the target here, or removes it if anything failed.
+             * @retval False if the last flush or the replacement failed
+             */
+            bool close(void) noexcept {
+                if(m_flusher.joinable()) {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_stopping = true;
+                    }
+                    m_wakeup.notify_all();
+                    m_flusher.join();
+                }
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_file == XENON_HF_no_file)
+                    return true;
+                bool flushed = m_good && flush_buffer(true);
+                if(m_atomic) {
+                    XENON_HF_pending_commit pending = { std::exchange(m_file, XENON_HF_no_file), &m_temporary, &m_target };
+                    if(flushed) [[likely]]
+                        flushed = XENON_HF_group_commit::instance().commit(pending);
+                    else {
+#ifdef XENON_M_WIN
+                        CloseHandle(pending.file);
+                        DeleteFileA(m_temporary.c_str());
+#else
+                        ::close(pending.file);
+                        unlink(m_temporary.c_str());
+#endif // XENON_M_WIN
+                    }
+                }
+                close_file();
+                return flushed;
+            }
+
+            /**
+             * @brief Checks whether the file is open.
+             * @note
+             * @retval True if open
+             */
+            [[nodiscard]] bool is_open(void) const noexcept {
+                return m_file != XENON_HF_no_file;
+            }
+
+            /**
+             * @brief Checks whether every write so far succeeded.
+             * @note   A writer that failed stays failed until it's reopened.
+             * @retval True if nothing failed
+             */
+            [[nodiscard]] bool good(void) const noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_good;
+            }
+
+            /**
+             * @brief Gets the amount of bytes waiting in the buffer.
+             * @note
+             * @retval Amount of bytes
+             */
+            [[nodiscard]] size_t buffered(void) const noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_size;
+            }
+
+            ~writer(void) noexcept {
+                close();
+            }
+        private:
+            /**
+             * @brief Writes the buffer and syncs. The mutex has to be held.
+             */
+            bool flush_buffer(const bool last) noexcept {
+                XENON_PROFILE_ZONE("xenon::files::writer::flush");
+                size_t size = m_size;
+#if !defined(XENON_M_WIN) && defined(O_DIRECT)
+                if(m_direct) {
+                    size = m_size / direct_alignment * direct_alignment;
+                    if(last && size != m_size) {
+                        // The tail isn't a whole block, so it goes out through the page cache and gets synced below
+                        fcntl(m_file, F_SETFL, fcntl(m_file, F_GETFL) & ~O_DIRECT);
+                        m_direct = false;
+                        size = m_size;
+                    }
+                }
+#endif // !defined(XENON_M_WIN) && defined(O_DIRECT)
+                std::string_view piece(m_buffer, size);
+                m_good = XENON_HF_write_pieces(m_file, &piece, 1, m_append);
+                if(!m_good) [[unlikely]]
+                    return false;
+                std::memmove(m_buffer, m_buffer + size, m_size - size);
+                m_size -= size;
+                m_unsynced |= size > 0;
+                if(m_level == durability::none || !m_unsynced)
+                    return true;
+                m_unsynced = false;
+                m_good = XENON_HF_sync_file(m_file);
+                return m_good;
+            }
+
+            void close_file(void) noexcept {
+                if(m_file != XENON_HF_no_file) {
+#ifdef XENON_M_WIN
+                    CloseHandle(m_file);
+#else
+                    ::close(m_file);
+#endif // XENON_M_WIN
+                }
+                m_file = XENON_HF_no_file;
+                if(m_buffer != nullptr)
+                    ::operator delete(m_buffer, std::align_val_t(direct_alignment));
+                m_buffer = nullptr;
+                m_size = 0;
+                m_good = false;
+            }
+
+            mutable std::mutex m_mutex;
+            std::condition_variable m_wakeup;
+            std::thread m_flusher;
+            XENON_HF_file_handle m_file = XENON_HF_no_file;
+            char* m_buffer = nullptr;
+            size_t m_capacity = 0;
+            size_t m_size = 0;
+            durability m_level = durability::none;
+            // Atomic writers write to m_temporary and rename it to m_target when they are closed
+            std::string m_target;
+            std::string m_temporary;
+            bool m_atomic = false;
+            bool m_append = false;
+            bool m_direct = false;
+            bool m_good = false;
+            // Something was written since the last sync
+            bool m_unsynced = false;
+            bool m_stopping = false;
+        };
+    } // namespace files
+} // namespace xenon
+
+#endif // XENON_HG_FILES_WRITER
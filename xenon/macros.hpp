@@ -15,4 +15,37 @@
 #endif // defined(_MSVC_LANG) && _MSVC_LANG > 201703L || __cplusplus >= 201703L
 #endif // _WIN32
 
+// Linux, for the system calls that only it has
+#ifdef __linux__
+#define XENON_M_LINUX
+
+// io_uring headers are available(the kernel can still refuse it at runtime)
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define XENON_M_IO_URING
+#endif // __has_include(<linux/io_uring.h>)
+#endif // defined(__has_include)
+#endif // __linux__
+
+// x86 or x64 CPU
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define XENON_M_X86
+#endif // defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+// Lets one function use an instruction set that the rest of the program isn't compiled for. MSVC doesn't need it
+#if defined(XENON_M_X86) && (defined(__GNUC__) || defined(__clang__))
+#define XENON_M_TARGET(isa) __attribute__((target(isa)))
+#else
+#define XENON_M_TARGET(isa)
+#endif // defined(XENON_M_X86) && (defined(__GNUC__) || defined(__clang__))
+
+// Profiler zones. They compile to nothing unless XENON_M_PROFILE is defined before including Xenon
+#define XENON_M_CONCAT_IMPL(a, b) a##b
+#define XENON_M_CONCAT(a, b) XENON_M_CONCAT_IMPL(a, b)
+#ifdef XENON_M_PROFILE
+#define XENON_PROFILE_ZONE(name) const xenon::bench::zone XENON_M_CONCAT(xenon_profile_zone_, __LINE__)(name)
+#else
+#define XENON_PROFILE_ZONE(name) static_cast<void>(0)
+#endif // XENON_M_PROFILE
+
 #endif // XENON_HG_MACROS
\ No newline at end of file
@@ -0,0 +1,513 @@
+// fill.hpp
+//
+// Bulk generation kernels that are a part of a Random module.
+// Used by random_engine's fill_integral and fill_floating_point.
+
+#ifndef XENON_HG_RANDOM_FILL
+#define XENON_HG_RANDOM_FILL
+
+// Libraries
+#include <span>
+#include <bit>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// Other parts of the Random component
+#include "generators.hpp"
+
+// Xenon's Modules
+#include "../macros.hpp"
+#include "../utilities/parts/cpu.hpp"
+
+#ifdef XENON_M_X86
+#include <immintrin.h>
+#endif // XENON_M_X86
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    enum class XENON_HF_random_simd {
+        scalar,
+        avx2,
+        avx512
+    };
+
+    inline XENON_HF_random_simd XENON_HF_random_simd_level(void) noexcept {
+        const xenon::utilities::cpu_features& features = xenon::utilities::cpu();
+        return features.avx512f ? XENON_HF_random_simd::avx512 : features.avx2 ? XENON_HF_random_simd::avx2 : XENON_HF_random_simd::scalar;
+    }
+
+    /**
+     * @brief Eight xoshiro256** generators side by side. Word-major, so that one SIMD register holds the same word of several lanes.
+     * @note   Every kernel steps all eight lanes and writes their outputs in lane order, so the numbers don't depend on which kernel ran.
+     */
+    struct XENON_HF_random_lanes {
+        alignas(64) uint64_t s[4][8];
+    };
+
+    /**
+     * @brief Draws 64 uniform bits from any UniformRandomBitGenerator.
+     */
+    template<typename G>
+    inline uint64_t XENON_HF_draw_64(G& gen) noexcept {
+        if constexpr(G::min() == 0 && G::max() == UINT64_MAX)
+            return static_cast<uint64_t>(gen());
+        else if constexpr(G::min() == 0 && G::max() == UINT32_MAX)
+            return (static_cast<uint64_t>(gen()) << 32) | static_cast<uint64_t>(gen());
+        else
+            return std::uniform_int_distribution<uint64_t>()(gen);
+    }
+
+    template<typename G>
+    inline XENON_HF_random_lanes XENON_HF_seed_lanes(G& gen) noexcept {
+        XENON_HF_random_lanes lanes;
+        for(size_t lane = 0; lane < 8; ++lane) {
+            uint64_t seed = XENON_HF_draw_64(gen);
+            for(size_t word = 0; word < 4; ++word)
+                lanes.s[word][lane] = XENON_HF_splitmix64(seed);
+        }
+        return lanes;
+    }
+
+    /**
+     * @brief Lemire's nearly divisionless bounded integer: the high half of x * range, rejecting the few x whose low half is below threshold = 2^32 mod range.
+     * @note   range 0 means the whole 32-bit range.
+     */
+    template<typename G>
+    inline uint32_t XENON_HF_bounded_32(G& gen, const uint32_t range, const uint32_t threshold) noexcept {
+        for(;;) {
+            const uint32_t x = static_cast<uint32_t>(XENON_HF_draw_64(gen));
+            if(range == 0) [[unlikely]]
+                return x;
+            const uint64_t product = static_cast<uint64_t>(x) * range;
+            if(static_cast<uint32_t>(product) >= threshold) [[likely]]
+                return static_cast<uint32_t>(product >> 32);
+        }
+    }
+
+    template<typename G>
+    inline uint64_t XENON_HF_bounded_64(G& gen, const uint64_t range, const uint64_t threshold) noexcept {
+        for(;;) {
+            const uint64_t x = XENON_HF_draw_64(gen);
+            if(range == 0) [[unlikely]]
+                return x;
+            uint64_t high, low;
+            XENON_HF_multiply_128(x, range, high, low);
+            if(low >= threshold) [[likely]]
+                return high;
+        }
+    }
+
+    inline double XENON_HF_unit_double(const uint64_t bits) noexcept {
+        return std::bit_cast<double>((bits >> 12) | 0x3FF0000000000000) - 1.0;
+    }
+
+    inline float XENON_HF_unit_float(const uint32_t bits) noexcept {
+        return std::bit_cast<float>((bits >> 9) | 0x3F800000u) - 1.0f;
+    }
+
+    // Scalar kernels. Each block is one step of all eight lanes
+
+    inline void XENON_HF_lanes_step(XENON_HF_random_lanes& lanes, uint64_t* out) noexcept {
+        for(size_t lane = 0; lane < 8; ++lane) {
+            const uint64_t s1 = lanes.s[1][lane];
+            out[lane] = std::rotl(s1 * 5, 7) * 9;
+            lanes.s[2][lane] ^= lanes.s[0][lane];
+            lanes.s[3][lane] ^= s1;
+            lanes.s[1][lane] ^= lanes.s[2][lane];
+            lanes.s[0][lane] ^= lanes.s[3][lane];
+            lanes.s[2][lane] ^= s1 << 17;
+            lanes.s[3][lane] = std::rotl(lanes.s[3][lane], 45);
+        }
+    }
+
+    inline void XENON_HF_random_bits_scalar(XENON_HF_random_lanes& lanes, uint64_t* out, const size_t blocks) noexcept {
+        for(size_t block = 0; block < blocks; ++block)
+            XENON_HF_lanes_step(lanes, out + block * 8);
+    }
+
+    inline void XENON_HF_random_bounded_scalar(XENON_HF_random_lanes& lanes, uint32_t* out, const size_t blocks, const uint32_t range, const uint32_t threshold, uint32_t* rejected, size_t& rejected_count) noexcept {
+        uint64_t bits[8];
+        for(size_t block = 0; block < blocks; ++block) {
+            XENON_HF_lanes_step(lanes, bits);
+            for(size_t i = 0; i < 16; ++i) {
+                const uint64_t product = static_cast<uint64_t>(static_cast<uint32_t>(bits[i / 2] >> (i % 2 * 32))) * range;
+                out[block * 16 + i] = static_cast<uint32_t>(product >> 32);
+                if(static_cast<uint32_t>(product) < threshold) [[unlikely]]
+                    rejected[rejected_count++] = static_cast<uint32_t>(block * 16 + i);
+            }
+        }
+    }
+
+    inline void XENON_HF_random_doubles_scalar(XENON_HF_random_lanes& lanes, double* out, const size_t blocks, const double from, const double scale) noexcept {
+        uint64_t bits[8];
+        for(size_t block = 0; block < blocks; ++block) {
+            XENON_HF_lanes_step(lanes, bits);
+            for(size_t i = 0; i < 8; ++i)
+                out[block * 8 + i] = from + XENON_HF_unit_double(bits[i]) * scale;
+        }
+    }
+
+    inline void XENON_HF_random_floats_scalar(XENON_HF_random_lanes& lanes, float* out, const size_t blocks, const float from, const float scale) noexcept {
+        uint64_t bits[8];
+        for(size_t block = 0; block < blocks; ++block) {
+            XENON_HF_lanes_step(lanes, bits);
+            for(size_t i = 0; i < 16; ++i)
+                out[block * 16 + i] = from + XENON_HF_unit_float(static_cast<uint32_t>(bits[i / 2] >> (i % 2 * 32))) * scale;
+        }
+    }
+
+#ifdef XENON_M_X86
+    // AVX2 kernels. Lanes 0-3 and 4-7 are two registers, which also hides the latency of one behind the other
+
+    XENON_M_TARGET("avx2") inline __m256i XENON_HF_xoshiro_avx2(__m256i (&s)[4]) noexcept {
+        const __m256i times_5 = _mm256_add_epi64(_mm256_slli_epi64(s[1], 2), s[1]);
+        const __m256i rotated = _mm256_or_si256(_mm256_slli_epi64(times_5, 7), _mm256_srli_epi64(times_5, 57));
+        const __m256i result = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+        const __m256i t = _mm256_slli_epi64(s[1], 17);
+        s[2] = _mm256_xor_si256(s[2], s[0]);
+        s[3] = _mm256_xor_si256(s[3], s[1]);
+        s[1] = _mm256_xor_si256(s[1], s[2]);
+        s[0] = _mm256_xor_si256(s[0], s[3]);
+        s[2] = _mm256_xor_si256(s[2], t);
+        s[3] = _mm256_or_si256(_mm256_slli_epi64(s[3], 45), _mm256_srli_epi64(s[3], 19));
+        return result;
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_lanes_load_avx2(const XENON_HF_random_lanes& lanes, __m256i (&low)[4], __m256i (&high)[4]) noexcept {
+        for(size_t word = 0; word < 4; ++word) {
+            low[word] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&lanes.s[word][0]));
+            high[word] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&lanes.s[word][4]));
+        }
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_lanes_store_avx2(XENON_HF_random_lanes& lanes, const __m256i (&low)[4], const __m256i (&high)[4]) noexcept {
+        for(size_t word = 0; word < 4; ++word) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&lanes.s[word][0]), low[word]);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&lanes.s[word][4]), high[word]);
+        }
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_random_bits_avx2(XENON_HF_random_lanes& lanes, uint64_t* out, const size_t blocks) noexcept {
+        __m256i low[4], high[4];
+        XENON_HF_lanes_load_avx2(lanes, low, high);
+        for(size_t block = 0; block < blocks; ++block) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + block * 8), XENON_HF_xoshiro_avx2(low));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + block * 8 + 4), XENON_HF_xoshiro_avx2(high));
+        }
+        XENON_HF_lanes_store_avx2(lanes, low, high);
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_bounded_avx2(const __m256i bits, uint32_t* out, const uint32_t index, const __m256i range, const __m256i threshold, uint32_t* rejected, size_t& rejected_count) noexcept {
+        // 32x32 -> 64 products of the low and the high halves of every word, interleaved back into 32-bit lanes
+        const __m256i even = _mm256_mul_epu32(bits, range);
+        const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(bits, 32), range);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + index), _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA));
+        const __m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        // AVX2 only compares signed, so both sides are flipped into signed order
+        const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_xor_si256(threshold, sign), _mm256_xor_si256(low, sign)))));
+        for(; mask != 0; mask &= mask - 1) [[unlikely]]
+            rejected[rejected_count++] = index + static_cast<uint32_t>(std::countr_zero(mask));
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_random_bounded_avx2(XENON_HF_random_lanes& lanes, uint32_t* out, const size_t blocks, const uint32_t range, const uint32_t threshold, uint32_t* rejected, size_t& rejected_count) noexcept {
+        __m256i low[4], high[4];
+        XENON_HF_lanes_load_avx2(lanes, low, high);
+        const __m256i range_ = _mm256_set1_epi64x(range);
+        const __m256i threshold_ = _mm256_set1_epi32(static_cast<int32_t>(threshold));
+        for(size_t block = 0; block < blocks; ++block) {
+            XENON_HF_bounded_avx2(XENON_HF_xoshiro_avx2(low), out, static_cast<uint32_t>(block * 16), range_, threshold_, rejected, rejected_count);
+            XENON_HF_bounded_avx2(XENON_HF_xoshiro_avx2(high), out, static_cast<uint32_t>(block * 16 + 8), range_, threshold_, rejected, rejected_count);
+        }
+        XENON_HF_lanes_store_avx2(lanes, low, high);
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_random_doubles_avx2(XENON_HF_random_lanes& lanes, double* out, const size_t blocks, const double from, const double scale) noexcept {
+        __m256i low[4], high[4];
+        XENON_HF_lanes_load_avx2(lanes, low, high);
+        const __m256i one_bits = _mm256_set1_epi64x(0x3FF0000000000000);
+        const __m256d one = _mm256_set1_pd(1.0), from_ = _mm256_set1_pd(from), scale_ = _mm256_set1_pd(scale);
+        for(size_t block = 0; block < blocks; ++block)
+            for(size_t half = 0; half < 2; ++half) {
+                const __m256i bits = XENON_HF_xoshiro_avx2(half == 0 ? low : high);
+                const __m256d unit = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 12), one_bits)), one);
+                _mm256_storeu_pd(out + block * 8 + half * 4, _mm256_add_pd(from_, _mm256_mul_pd(unit, scale_)));
+            }
+        XENON_HF_lanes_store_avx2(lanes, low, high);
+    }
+
+    XENON_M_TARGET("avx2") inline void XENON_HF_random_floats_avx2(XENON_HF_random_lanes& lanes, float* out, const size_t blocks, const float from, const float scale) noexcept {
+        __m256i low[4], high[4];
+        XENON_HF_lanes_load_avx2(lanes, low, high);
+        const __m256i one_bits = _mm256_set1_epi32(0x3F800000);
+        const __m256 one = _mm256_set1_ps(1.0f), from_ = _mm256_set1_ps(from), scale_ = _mm256_set1_ps(scale);
+        for(size_t block = 0; block < blocks; ++block)
+            for(size_t half = 0; half < 2; ++half) {
+                const __m256i bits = XENON_HF_xoshiro_avx2(half == 0 ? low : high);
+                const __m256 unit = _mm256_sub_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(bits, 9), one_bits)), one);
+                _mm256_storeu_ps(out + block * 16 + half * 8, _mm256_add_ps(from_, _mm256_mul_ps(unit, scale_)));
+            }
+        XENON_HF_lanes_store_avx2(lanes, low, high);
+    }
+
+    // AVX-512 kernels. All eight lanes fit into one register
+    // GCC 12 warns about the deliberately undefined registers inside its own AVX-512 intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif // defined(__GNUC__) && !defined(__clang__)
+
+    XENON_M_TARGET("avx512f") inline __m512i XENON_HF_xoshiro_avx512(__m512i (&s)[4]) noexcept {
+        const __m512i result = _mm512_rol_epi64(_mm512_add_epi64(_mm512_slli_epi64(s[1], 2), s[1]), 7);
+        const __m512i t = _mm512_slli_epi64(s[1], 17);
+        s[2] = _mm512_xor_si512(s[2], s[0]);
+        s[3] = _mm512_xor_si512(s[3], s[1]);
+        s[1] = _mm512_xor_si512(s[1], s[2]);
+        s[0] = _mm512_xor_si512(s[0], s[3]);
+        s[2] = _mm512_xor_si512(s[2], t);
+        s[3] = _mm512_rol_epi64(s[3], 45);
+        return _mm512_add_epi64(_mm512_slli_epi64(result, 3), result);
+    }
+
+    XENON_M_TARGET("avx512f") inline void XENON_HF_random_bits_avx512(XENON_HF_random_lanes& lanes, uint64_t* out, const size_t blocks) noexcept {
+        __m512i s[4];
+        for(size_t word = 0; word < 4; ++word)
+            s[word] = _mm512_load_si512(lanes.s[word]);
+        for(size_t block = 0; block < blocks; ++block)
+            _mm512_storeu_si512(out + block * 8, XENON_HF_xoshiro_avx512(s));
+        for(size_t word = 0; word < 4; ++word)
+            _mm512_store_si512(lanes.s[word], s[word]);
+    }
+
+    XENON_M_TARGET("avx512f") inline void XENON_HF_random_bounded_avx512(XENON_HF_random_lanes& lanes, uint32_t* out, const size_t blocks, const uint32_t range, const uint32_t threshold, uint32_t* rejected, size_t& rejected_count) noexcept {
+        __m512i s[4];
+        for(size_t word = 0; word < 4; ++word)
+            s[word] = _mm512_load_si512(lanes.s[word]);
+        const __m512i range_ = _mm512_set1_epi64(range);
+        const __m512i threshold_ = _mm512_set1_epi32(static_cast<int32_t>(threshold));
+        for(size_t block = 0; block < blocks; ++block) {
+            const __m512i bits = XENON_HF_xoshiro_avx512(s);
+            const __m512i even = _mm512_mul_epu32(bits, range_);
+            const __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(bits, 32), range_);
+            _mm512_storeu_si512(out + block * 16, _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd));
+            uint32_t mask = _mm512_cmplt_epu32_mask(_mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32)), threshold_);
+            for(; mask != 0; mask &= mask - 1) [[unlikely]]
+                rejected[rejected_count++] = static_cast<uint32_t>(block * 16) + static_cast<uint32_t>(std::countr_zero(mask));
+        }
+        for(size_t word = 0; word < 4; ++word)
+            _mm512_store_si512(lanes.s[word], s[word]);
+    }
+
+    XENON_M_TARGET("avx512f") inline void XENON_HF_random_doubles_avx512(XENON_HF_random_lanes& lanes, double* out, const size_t blocks, const double from, const double scale) noexcept {
+        __m512i s[4];
+        for(size_t word = 0; word < 4; ++word)
+            s[word] = _mm512_load_si512(lanes.s[word]);
+        const __m512i one_bits = _mm512_set1_epi64(0x3FF0000000000000);
+        const __m512d one = _mm512_set1_pd(1.0), from_ = _mm512_set1_pd(from), scale_ = _mm512_set1_pd(scale);
+        for(size_t block = 0; block < blocks; ++block) {
+            const __m512d unit = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(XENON_HF_xoshiro_avx512(s), 12), one_bits)), one);
+            _mm512_storeu_pd(out + block * 8, _mm512_add_pd(from_, _mm512_mul_pd(unit, scale_)));
+        }
+        for(size_t word = 0; word < 4; ++word)
+            _mm512_store_si512(lanes.s[word], s[word]);
+    }
+
+    XENON_M_TARGET("avx512f") inline void XENON_HF_random_floats_avx512(XENON_HF_random_lanes& lanes, float* out, const size_t blocks, const float from, const float scale) noexcept {
+        __m512i s[4];
+        for(size_t word = 0; word < 4; ++word)
+            s[word] = _mm512_load_si512(lanes.s[word]);
+        const __m512i one_bits = _mm512_set1_epi32(0x3F800000);
+        const __m512 one = _mm512_set1_ps(1.0f), from_ = _mm512_set1_ps(from), scale_ = _mm512_set1_ps(scale);
+        for(size_t block = 0; block < blocks; ++block) {
+            const __m512 unit = _mm512_sub_ps(_mm512_castsi512_ps(_mm512_or_si512(_mm512_srli_epi32(XENON_HF_xoshiro_avx512(s), 9), one_bits)), one);
+            _mm512_storeu_ps(out + block * 16, _mm512_add_ps(from_, _mm512_mul_ps(unit, scale_)));
+        }
+        for(size_t word = 0; word < 4; ++word)
+            _mm512_store_si512(lanes.s[word], s[word]);
+    }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif // defined(__GNUC__) && !defined(__clang__)
+#endif // XENON_M_X86
+
+    // Dispatch
+
+    inline void XENON_HF_random_bits(const XENON_HF_random_simd simd, XENON_HF_random_lanes& lanes, uint64_t* out, const size_t blocks) noexcept {
+#ifdef XENON_M_X86
+        if(simd == XENON_HF_random_simd::avx512)
+            return XENON_HF_random_bits_avx512(lanes, out, blocks);
+        if(simd == XENON_HF_random_simd::avx2)
+            return XENON_HF_random_bits_avx2(lanes, out, blocks);
+#endif // XENON_M_X86
+        XENON_HF_random_bits_scalar(lanes, out, blocks);
+    }
+
+    inline void XENON_HF_random_bounded(const XENON_HF_random_simd simd, XENON_HF_random_lanes& lanes, uint32_t* out, const size_t blocks, const uint32_t range, const uint32_t threshold, uint32_t* rejected, size_t& rejected_count) noexcept {
+#ifdef XENON_M_X86
+        if(simd == XENON_HF_random_simd::avx512)
+            return XENON_HF_random_bounded_avx512(lanes, out, blocks, range, threshold, rejected, rejected_count);
+        if(simd == XENON_HF_random_simd::avx2)
+            return XENON_HF_random_bounded_avx2(lanes, out, blocks, range, threshold, rejected, rejected_count);
+#endif // XENON_M_X86
+        XENON_HF_random_bounded_scalar(lanes, out, blocks, range, threshold, rejected, rejected_count);
+    }
+
+    inline void XENON_HF_random_doubles(const XENON_HF_random_simd simd, XENON_HF_random_lanes& lanes, double* out, const size_t blocks, const double from, const double scale) noexcept {
+#ifdef XENON_M_X86
+        if(simd == XENON_HF_random_simd::avx512)
+            return XENON_HF_random_doubles_avx512(lanes, out, blocks, from, scale);
+        if(simd == XENON_HF_random_simd::avx2)
+            return XENON_HF_random_doubles_avx2(lanes, out, blocks, from, scale);
+#endif // XENON_M_X86
+        XENON_HF_random_doubles_scalar(lanes, out, blocks, from, scale);
+    }
+
+    inline void XENON_HF_random_floats(const XENON_HF_random_simd simd, XENON_HF_random_lanes& lanes, float* out, const size_t blocks, const float from, const float scale) noexcept {
+#ifdef XENON_M_X86
+        if(simd == XENON_HF_random_simd::avx512)
+            return XENON_HF_random_floats_avx512(lanes, out, blocks, from, scale);
+        if(simd == XENON_HF_random_simd::avx2)
+            return XENON_HF_random_floats_avx2(lanes, out, blocks, from, scale);
+#endif // XENON_M_X86
+        XENON_HF_random_floats_scalar(lanes, out, blocks, from, scale);
+    }
+
+    // Spans shorter than this are filled straight from the engine's generator, since seeding the lanes takes eight draws
+    constexpr size_t XENON_HF_fill_threshold = 64;
+
+    template<typename G, typename T>
+    inline void XENON_HF_fill_integral(G& gen, const std::span<T> out, const T from, const T to, const XENON_HF_random_simd simd = XENON_HF_random_simd_level()) noexcept {
+        using unsigned_t = std::make_unsigned_t<T>;
+        if constexpr(sizeof(T) <= 4) {
+            // 0 when the range is every 32-bit value
+            const uint32_t range = static_cast<uint32_t>(static_cast<unsigned_t>(static_cast<unsigned_t>(to) - static_cast<unsigned_t>(from))) + 1;
+            const uint32_t threshold = range == 0 ? 0 : (0u - range) % range;
+            const uint32_t base = static_cast<uint32_t>(static_cast<unsigned_t>(from));
+            if(out.size() < XENON_HF_fill_threshold) {
+                if(range == 0 || range > 0x10000) {
+                    for(T& value : out)
+                        value = static_cast<T>(base + XENON_HF_bounded_32(gen, range, threshold));
+                    return;
+                }
+                // Small ranges, like characters of a string, take 16 bits each, so one draw gives four values
+                const uint32_t threshold_16 = (0x10000u - range) % range;
+                uint64_t bits = 0;
+                uint32_t left = 0;
+                for(T& value : out)
+                    for(;;) {
+                        if(left == 0) {
+                            bits = XENON_HF_draw_64(gen);
+                            left = 4;
+                        }
+                        const uint32_t product = static_cast<uint32_t>(bits & 0xFFFF) * range;
+                        bits >>= 16;
+                        --left;
+                        if((product & 0xFFFF) >= threshold_16) [[likely]] {
+                            value = static_cast<T>(base + (product >> 16));
+                            break;
+                        }
+                    }
+                return;
+            }
+
+            XENON_HF_random_lanes lanes = XENON_HF_seed_lanes(gen);
+            constexpr size_t chunk = 1024;
+            alignas(64) uint32_t buffer[chunk];
+            uint32_t rejected[chunk];
+            for(size_t offset = 0; offset < out.size(); offset += chunk) {
+                const size_t count = std::min(chunk, out.size() - offset);
+                // 32-bit spans are written in place, everything else goes through the buffer
+                const bool direct = sizeof(T) == sizeof(uint32_t) && count % 16 == 0;
+                uint32_t* const values = direct ? reinterpret_cast<uint32_t*>(out.data() + offset) : buffer;
+                if(range == 0) [[unlikely]] {
+                    uint64_t bits[chunk / 2];
+                    XENON_HF_random_bits(simd, lanes, bits, (count + 15) / 16);
+                    std::memcpy(values, bits, count * sizeof(uint32_t));
+                } else {
+                    size_t rejected_count = 0;
+                    XENON_HF_random_bounded(simd, lanes, values, (count + 15) / 16, range, threshold, rejected, rejected_count);
+                    for(size_t i = 0; i < rejected_count; ++i)
+                        values[rejected[i]] = XENON_HF_bounded_32(gen, range, threshold);
+                }
+                if(!direct || base != 0)
+                    for(size_t i = 0; i < count; ++i)
+                        out[offset + i] = static_cast<T>(base + values[i]);
+            }
+        } else {
+            const uint64_t range = static_cast<uint64_t>(static_cast<unsigned_t>(to) - static_cast<unsigned_t>(from)) + 1;
+            const uint64_t threshold = range == 0 ? 0 : (0ull - range) % range;
+            const uint64_t base = static_cast<uint64_t>(static_cast<unsigned_t>(from));
+            if(out.size() < XENON_HF_fill_threshold) {
+                for(T& value : out)
+                    value = static_cast<T>(base + XENON_HF_bounded_64(gen, range, threshold));
+                return;
+            }
+
+            XENON_HF_random_lanes lanes = XENON_HF_seed_lanes(gen);
+            constexpr size_t chunk = 512;
+            alignas(64) uint64_t bits[chunk];
+            for(size_t offset = 0; offset < out.size(); offset += chunk) {
+                const size_t count = std::min(chunk, out.size() - offset);
+                XENON_HF_random_bits(simd, lanes, bits, (count + 7) / 8);
+                for(size_t i = 0; i < count; ++i) {
+                    uint64_t value = bits[i];
+                    if(range != 0) [[likely]] {
+                        uint64_t low;
+                        XENON_HF_multiply_128(bits[i], range, value, low);
+                        if(low < threshold) [[unlikely]]
+                            value = XENON_HF_bounded_64(gen, range, threshold);
+                    }
+                    out[offset + i] = static_cast<T>(base + value);
+                }
+            }
+        }
+    }
+
+    template<typename G, typename T>
+    inline void XENON_HF_fill_floating_point(G& gen, const std::span<T> out, const T from, const T to, const XENON_HF_random_simd simd = XENON_HF_random_simd_level()) noexcept {
+        if(out.size() < XENON_HF_fill_threshold) {
+            // A unit double close to 1 would round to 1.0f, so floats draw a unit float the way the kernels do
+            for(T& value : out) {
+                if constexpr(std::is_same_v<T, float>)
+                    value = from + XENON_HF_unit_float(static_cast<uint32_t>(XENON_HF_draw_64(gen) >> 32)) * (to - from);
+                else
+                    value = from + static_cast<T>(XENON_HF_unit_double(XENON_HF_draw_64(gen))) * (to - from);
+            }
+            return;
+        }
+
+        XENON_HF_random_lanes lanes = XENON_HF_seed_lanes(gen);
+        if constexpr(std::is_same_v<T, double> || std::is_same_v<T, float>) {
+            // Whole blocks go straight into the span and only the tail goes through a buffer
+            constexpr size_t per_block = 64 / sizeof(T);
+            const size_t blocks = out.size() / per_block;
+            const size_t tail = out.size() % per_block;
+            T last[per_block];
+            if constexpr(std::is_same_v<T, double>) {
+                XENON_HF_random_doubles(simd, lanes, out.data(), blocks, from, to - from);
+                XENON_HF_random_doubles(simd, lanes, last, tail != 0, from, to - from);
+            } else {
+                XENON_HF_random_floats(simd, lanes, out.data(), blocks, from, to - from);
+                XENON_HF_random_floats(simd, lanes, last, tail != 0, from, to - from);
+            }
+            std::copy_n(last, tail, out.data() + blocks * per_block);
+        } else {
+            constexpr size_t chunk = 512;
+            double unit[chunk];
+            for(size_t offset = 0; offset < out.size(); offset += chunk) {
+                const size_t count = std::min(chunk, out.size() - offset);
+                XENON_HF_random_doubles(simd, lanes, unit, (count + 7) / 8, 0.0, 1.0);
+                for(size_t i = 0; i < count; ++i)
+                    out[offset + i] = from + static_cast<T>(unit[i]) * (to - from);
+            }
+        }
+    }
+}
+
+#endif // XENON_HG_RANDOM_FILL
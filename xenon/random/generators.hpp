@@ -0,0 +1,374 @@
+// generators.hpp
+//
+// Pseudo random number generators that are a part of a Random module.
+
+#ifndef XENON_HG_RANDOM_GENERATORS
+#define XENON_HG_RANDOM_GENERATORS
+
+// Libraries
+#include <random>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif // defined(_MSC_VER) && defined(_M_X64)
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    /**
+     * @brief Multiplies two 64-bit numbers into a 128-bit one.
+     */
+    inline void XENON_HF_multiply_128(const uint64_t a, const uint64_t b, uint64_t& high, uint64_t& low) noexcept {
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        high = static_cast<uint64_t>(product >> 64);
+        low = static_cast<uint64_t>(product);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        low = _umul128(a, b, &high);
+#else
+        const uint64_t a_low = a & 0xFFFFFFFF, a_high = a >> 32;
+        const uint64_t b_low = b & 0xFFFFFFFF, b_high = b >> 32;
+        const uint64_t low_low = a_low * b_low, high_low = a_high * b_low, low_high = a_low * b_high, high_high = a_high * b_high;
+        const uint64_t middle = (low_low >> 32) + (high_low & 0xFFFFFFFF) + low_high;
+        high = high_high + (high_low >> 32) + (middle >> 32);
+        low = (middle << 32) | (low_low & 0xFFFFFFFF);
+#endif // defined(__SIZEOF_INT128__)
+    }
+
+    /**
+     * @brief SplitMix64. Spreads one seed over the bigger state of the other generators.
+     */
+    inline uint64_t XENON_HF_splitmix64(uint64_t& state) noexcept {
+        uint64_t z = (state += 0x9E3779B97F4A7C15);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief A new seed for every generator that isn't given one. std::random_device is only asked once per process, after that it's a counter put through SplitMix64.
+     */
+    inline uint64_t XENON_HF_random_seed(void) noexcept {
+        static const uint64_t base = []() {
+            std::random_device rd;
+            return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+        }();
+        static std::atomic<uint64_t> counter = 0;
+        uint64_t state = base + counter.fetch_add(1, std::memory_order_relaxed) * 0xD1B54A32D192ED03;
+        return XENON_HF_splitmix64(state);
+    }
+}
+
+namespace xenon {
+    namespace random {
+        /**
+         * @brief xoshiro256** by Blackman and Vigna. 32 bytes of state, a period of 2^256 - 1 and passes BigCrush. The default generator.
+         * @note   Satisfies UniformRandomBitGenerator, so it works with the standard distributions too.
+         */
+        class xoshiro256ss final {
+        public:
+            using result_type = uint64_t;
+
+            /**
+             * @brief Constructs the generator with a seed that is different for every generator.
+             * @note
+             */
+            xoshiro256ss(void) noexcept {
+                seed(XENON_HF_random_seed());
+            }
+
+            /**
+             * @brief Constructs the generator with a seed.
+             * @note
+             * @param  value: The seed
+             */
+            explicit xoshiro256ss(const uint64_t value) noexcept {
+                seed(value);
+            }
+
+            /**
+             * @brief Starts the sequence over from a seed.
+             * @note
+             * @param  value: The seed
+             * @retval None
+             */
+            void seed(uint64_t value) noexcept {
+                for(uint64_t& word : m_state)
+                    word = XENON_HF_splitmix64(value);
+            }
+
+            /**
+             * @brief Generates the next number.
+             * @note
+             * @retval A random number
+             */
+            result_type operator()(void) noexcept {
+                const uint64_t result = std::rotl(m_state[1] * 5, 7) * 9;
+                const uint64_t t = m_state[1] << 17;
+                m_state[2] ^= m_state[0];
+                m_state[3] ^= m_state[1];
+                m_state[1] ^= m_state[2];
+                m_state[0] ^= m_state[3];
+                m_state[2] ^= t;
+                m_state[3] = std::rotl(m_state[3], 45);
+                return result;
+            }
+
+            /**
+             * @brief Skips 2^128 numbers. Generators that are jumped from the same one never overlap unless one of them draws 2^128 numbers.
+             * @note
+             * @retval None
+             */
+            void jump(void) noexcept {
+                constexpr uint64_t polynomial[] = { 0x180EC6D33CFD0ABA, 0xD5A61266F0C9392C, 0xA9582618E03FC9AA, 0x39ABDC4529B1661C };
+                jump_by(polynomial);
+            }
+
+            /**
+             * @brief Skips 2^192 numbers. Gives 2^64 starting points that each have 2^64 room for jump().
+             * @note
+             * @retval None
+             */
+            void long_jump(void) noexcept {
+                constexpr uint64_t polynomial[] = { 0x76E15D3EFEFDCBBF, 0xC5004E441C522FB3, 0x77710069854EE241, 0x39109BB02ACBE635 };
+                jump_by(polynomial);
+            }
+
+            [[nodiscard]] static constexpr result_type min(void) noexcept {
+                return 0;
+            }
+
+            [[nodiscard]] static constexpr result_type max(void) noexcept {
+                return UINT64_MAX;
+            }
+        private:
+            void jump_by(const uint64_t (&polynomial)[4]) noexcept {
+                uint64_t jumped[4] = {};
+                for(const uint64_t word : polynomial)
+                    for(uint32_t bit = 0; bit < 64; ++bit) {
+                        if((word >> bit) & 1)
+                            for(size_t i = 0; i < 4; ++i)
+                                jumped[i] ^= m_state[i];
+                        operator()();
+                    }
+                for(size_t i = 0; i < 4; ++i)
+                    m_state[i] = jumped[i];
+            }
+
+            uint64_t m_state[4];
+        };
+
+        /**
+         * @brief PCG64(XSL RR 128/64) by O'Neill. A 128-bit LCG with a permuted output, 32 bytes of state and a period of 2^128.
+         * @note   Satisfies UniformRandomBitGenerator, so it works with the standard distributions too.
+         */
+        class pcg64 final {
+        public:
+            using result_type = uint64_t;
+
+            /**
+             * @brief Constructs the generator with a seed that is different for every generator.
+             * @note
+             */
+            pcg64(void) noexcept {
+                seed(XENON_HF_random_seed());
+            }
+
+            /**
+             * @brief Constructs the generator with a seed.
+             * @note
+             * @param  value: The seed
+             */
+            explicit pcg64(const uint64_t value) noexcept {
+                seed(value);
+            }
+
+            /**
+             * @brief Starts the sequence over from a seed.
+             * @note
+             * @param  value: The seed
+             * @retval None
+             */
+            void seed(uint64_t value) noexcept {
+                m_increment_high = XENON_HF_splitmix64(value);
+                m_increment_low = XENON_HF_splitmix64(value) | 1;
+                m_state_high = 0;
+                m_state_low = 0;
+                step();
+                m_state_high += XENON_HF_splitmix64(value);
+                m_state_low += XENON_HF_splitmix64(value);
+                step();
+            }
+
+            /**
+             * @brief Generates the next number.
+             * @note
+             * @retval A random number
+             */
+            result_type operator()(void) noexcept {
+                step();
+                return std::rotr(m_state_high ^ m_state_low, static_cast<int32_t>(m_state_high >> 58));
+            }
+
+            /**
+             * @brief Skips numbers in O(log delta) steps.
+             * @note
+             * @param  delta: Amount of numbers to skip
+             * @retval None
+             */
+            void advance(const uint64_t delta) noexcept {
+                advance_by(0, delta);
+            }
+
+            /**
+             * @brief Skips 2^64 numbers. Generators that are jumped from the same one never overlap unless one of them draws 2^64 numbers.
+             * @note
+             * @retval None
+             */
+            void jump(void) noexcept {
+                advance_by(1, 0);
+            }
+
+            [[nodiscard]] static constexpr result_type min(void) noexcept {
+                return 0;
+            }
+
+            [[nodiscard]] static constexpr result_type max(void) noexcept {
+                return UINT64_MAX;
+            }
+        private:
+            // (a_high, a_low) * (b_high, b_low), modulo 2^128
+            static void multiply(uint64_t& a_high, uint64_t& a_low, const uint64_t b_high, const uint64_t b_low) noexcept {
+                uint64_t high, low;
+                XENON_HF_multiply_128(a_low, b_low, high, low);
+                a_high = high + a_high * b_low + a_low * b_high;
+                a_low = low;
+            }
+
+            static void add(uint64_t& a_high, uint64_t& a_low, const uint64_t b_high, const uint64_t b_low) noexcept {
+                a_low += b_low;
+                a_high += b_high + (a_low < b_low);
+            }
+
+            // Brown's "Random number generation with arbitrary strides": squares the step until it covers every bit of delta
+            void advance_by(const uint64_t delta_high, const uint64_t delta_low) noexcept {
+                uint64_t total_multiplier_high = 0, total_multiplier_low = 1, total_increment_high = 0, total_increment_low = 0;
+                uint64_t multiplier_high_ = multiplier_high, multiplier_low_ = multiplier_low;
+                uint64_t increment_high = m_increment_high, increment_low = m_increment_low;
+                for(uint32_t bit = 0; bit < 128; ++bit) {
+                    if(((bit < 64 ? delta_low >> bit : delta_high >> (bit - 64)) & 1) != 0) {
+                        multiply(total_multiplier_high, total_multiplier_low, multiplier_high_, multiplier_low_);
+                        multiply(total_increment_high, total_increment_low, multiplier_high_, multiplier_low_);
+                        add(total_increment_high, total_increment_low, increment_high, increment_low);
+                    }
+                    // increment = (multiplier + 1) * increment, multiplier = multiplier^2
+                    uint64_t next_high = multiplier_high_, next_low = multiplier_low_;
+                    add(next_high, next_low, 0, 1);
+                    multiply(increment_high, increment_low, next_high, next_low);
+                    multiply(multiplier_high_, multiplier_low_, multiplier_high_, multiplier_low_);
+                }
+                multiply(m_state_high, m_state_low, total_multiplier_high, total_multiplier_low);
+                add(m_state_high, m_state_low, total_increment_high, total_increment_low);
+            }
+
+            static constexpr uint64_t multiplier_high = 0x2360ED051FC65DA4;
+            static constexpr uint64_t multiplier_low = 0x4385DF649FCCF645;
+
+            // state = state * multiplier + increment, modulo 2^128
+            void step(void) noexcept {
+                uint64_t high, low;
+                XENON_HF_multiply_128(m_state_low, multiplier_low, high, low);
+                high += m_state_high * multiplier_low + m_state_low * multiplier_high;
+                m_state_low = low + m_increment_low;
+                m_state_high = high + m_increment_high + (m_state_low < low);
+            }
+
+            uint64_t m_state_high;
+            uint64_t m_state_low;
+            uint64_t m_increment_high;
+            uint64_t m_increment_low;
+        };
+
+        /**
+         * @brief wyrand by Wang Yi. 8 bytes of state and one multiplication per number, the fastest of the three. Passes BigCrush and PractRand.
+         * @note   Satisfies UniformRandomBitGenerator, so it works with the standard distributions too.
+         */
+        class wyrand final {
+        public:
+            using result_type = uint64_t;
+
+            /**
+             * @brief Constructs the generator with a seed that is different for every generator.
+             * @note
+             */
+            wyrand(void) noexcept
+                : m_state(XENON_HF_random_seed()) {}
+
+            /**
+             * @brief Constructs the generator with a seed.
+             * @note
+             * @param  value: The seed
+             */
+            explicit wyrand(const uint64_t value) noexcept
+                : m_state(value) {}
+
+            /**
+             * @brief Starts the sequence over from a seed.
+             * @note
+             * @param  value: The seed
+             * @retval None
+             */
+            void seed(const uint64_t value) noexcept {
+                m_state = value;
+            }
+
+            /**
+             * @brief Generates the next number.
+             * @note
+             * @retval A random number
+             */
+            result_type operator()(void) noexcept {
+                m_state += increment;
+                uint64_t high, low;
+                XENON_HF_multiply_128(m_state, m_state ^ 0xE7037ED1A0B428DB, high, low);
+                return high ^ low;
+            }
+
+            /**
+             * @brief Skips numbers in one step, since the state is a counter.
+             * @note
+             * @param  delta: Amount of numbers to skip
+             * @retval None
+             */
+            void advance(const uint64_t delta) noexcept {
+                m_state += delta * increment;
+            }
+
+            /**
+             * @brief Skips 2^48 numbers. Generators that are jumped from the same one never overlap unless one of them draws 2^48 numbers.
+             * @note   The whole period is 2^64, so there is room for 2^16 such streams.
+             * @retval None
+             */
+            void jump(void) noexcept {
+                advance(uint64_t(1) << 48);
+            }
+
+            [[nodiscard]] static constexpr result_type min(void) noexcept {
+                return 0;
+            }
+
+            [[nodiscard]] static constexpr result_type max(void) noexcept {
+                return UINT64_MAX;
+            }
+        private:
+            static constexpr uint64_t increment = 0xA0761D6478BD642F;
+
+            uint64_t m_state;
+        };
+    } // namespace random
+} // namespace xenon
+
+#endif // XENON_HG_RANDOM_GENERATORS
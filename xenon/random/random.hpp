@@ -7,9 +7,19 @@
 
 // Libraries
 #include <random>
-#include <memory>
+#include <span>
+#include <vector>
+#include <iterator>
 #include <string>
-#include <sstream>
+#include <mutex>
+#include <cstdint>
+#include <type_traits>
+
+// Other parts of the Random component
+#include "generators.hpp"
+#include "fill.hpp"
+#include "uuid.hpp"
+#include "sampling.hpp"
 
 // Xenon's Dependencies
 #include "../concepts/concepts.hpp"
@@ -18,13 +28,55 @@ namespace xenon {
     namespace random {
         /**
          * @brief A class that allows you to get random stuff.  
-         * @note   
+         * @note   The generator is stored inline, so drawing a number doesn't chase a pointer. Use random_engine for the default generator.
          */
-        class random_engine final {
+        template<typename G>
+            requires std::uniform_random_bit_generator<G>
+        class basic_random_engine final {
         public:
-            random_engine(void) noexcept {
-                std::random_device rd;
-                gen = std::make_unique<std::mt19937>(rd());
+            /**
+             * @brief Constructs the engine with a generator that seeds itself.
+             * @note   
+             */
+            basic_random_engine(void) noexcept = default;
+
+            /**
+             * @brief Constructs the engine with a seed, so that it gives the same sequence every time.
+             * @note   
+             * @param  seed: The seed
+             */
+            explicit basic_random_engine(const uint64_t seed) noexcept
+                : m_generator(seed) {}
+
+            /**
+             * @brief Skips far ahead in the sequence, see the generator's jump().
+             * @note   
+             * @retval None
+             */
+            void jump(void) noexcept
+                requires requires(G& gen) { gen.jump(); } {
+                m_generator.jump();
+            }
+
+            /**
+             * @brief Hands the next stretch of the sequence to a new engine and jumps past it.
+             * @note   Splitting one seeded engine N times gives N engines whose numbers never overlap, so parallel runs are reproducible without locking.
+             * @retval An engine that starts where this one was
+             */
+            [[nodiscard]] basic_random_engine split(void) noexcept
+                requires requires(G& gen) { gen.jump(); } {
+                basic_random_engine child = *this;
+                m_generator.jump();
+                return child;
+            }
+
+            /**
+             * @brief Gets the underlying generator.
+             * @note   
+             * @retval The generator
+             */
+            [[nodiscard]] G& generator(void) noexcept {
+                return m_generator;
             }
 
             /**
@@ -38,7 +90,7 @@ namespace xenon {
                 requires xenon::concepts::integral<T>
             [[nodiscard]] inline T get_integral(const T from, const T to) noexcept {
                 std::uniform_int_distribution<T> distr(from, to);
-                return static_cast<T>(distr(*gen.get()));
+                return static_cast<T>(distr(m_generator));
             }
 
             /**
@@ -52,7 +104,36 @@ namespace xenon {
                 requires xenon::concepts::floating_point<T>
             [[nodiscard]] inline T get_floating_point(const T from, const T to) noexcept {
                 std::uniform_real_distribution<T> distr(from, to);
-                return static_cast<T>(distr(*gen.get()));
+                return static_cast<T>(distr(m_generator));
+            }
+
+            /**
+             * @brief Fills a buffer with integral random numbers in some range.
+             * @note   Uses Lemire's bounded integers on eight xoshiro256** streams at once, with AVX-512 or AVX2 when the CPU has them.
+             *         Gives the same numbers on every CPU. A vector converts to the span when T is given explicitly: fill_integral<int32_t>(vec, 0, 9)
+             * @param  out: The buffer
+             * @param  from: Start of the range
+             * @param  to: End of the range, inclusive
+             * @retval None
+             */
+            template<typename T>
+                requires xenon::concepts::integral<T> && (!std::is_same_v<T, bool>)
+            void fill_integral(const std::span<T> out, const T from, const T to) noexcept {
+                XENON_HF_fill_integral(m_generator, out, from, to);
+            }
+
+            /**
+             * @brief Fills a buffer with floating random numbers in some range.
+             * @note   Floats have 23 random bits and doubles 52. Uses AVX-512 or AVX2 when the CPU has them.
+             * @param  out: The buffer
+             * @param  from: Start of the range
+             * @param  to: End of the range, exclusive
+             * @retval None
+             */
+            template<typename T>
+                requires xenon::concepts::floating_point<T>
+            void fill_floating_point(const std::span<T> out, const T from, const T to) noexcept {
+                XENON_HF_fill_floating_point(m_generator, out, from, to);
             }
 
             /**
@@ -71,13 +152,21 @@ namespace xenon {
              * @retval A random string
              */
             [[nodiscard]] std::string get_string(const uint32_t len = 20) noexcept {
-                std::string rand_str = "";
-                rand_str.reserve(len);
-                for(uint32_t i = 0; i < len; ++i)
-                    rand_str += get_char();
+                std::string rand_str(len, '\0');
+                get_string(std::span<char>(rand_str));
                 return rand_str;
             }
 
+            /**
+             * @brief Fills a buffer with random characters out of all printable characters except space.
+             * @note   Doesn't allocate. Long buffers go through fill_integral.
+             * @param  out: The buffer
+             * @retval None
+             */
+            void get_string(const std::span<char> out) noexcept {
+                fill_integral<char>(out, 33, 126);
+            }
+
             /**
              * @brief Generates a random boolean.
              * @note   
@@ -89,39 +178,118 @@ namespace xenon {
 
             /**
              * @brief Generates a random UUID.
-             * @note   
+             * @note   A version 4 UUID, same as get_uuid_v4().str()
              * @retval A random UUID
              */
             [[nodiscard]] std::string get_uuid(void) noexcept {
-                std::stringstream ss;
-                ss << std::hex;
+                return get_uuid_v4().str();
+            }
 
-                for (uint32_t i = 0; i < 8; i++)
-                    ss << get_integral<int32_t>(0, 15);
-                ss << "-";
+            /**
+             * @brief Writes a random(version 4) UUID into a buffer without allocating.
+             * @note   
+             * @param  out: The buffer for the 36 characters. No null terminator is written
+             * @retval None
+             */
+            void get_uuid(const std::span<char, uuid::length> out) noexcept {
+                const uint64_t high = XENON_HF_uuid_v4_high(XENON_HF_draw_64(m_generator));
+                XENON_HF_format_uuid(high, XENON_HF_uuid_low(XENON_HF_draw_64(m_generator)), out.data());
+            }
 
-                for (uint32_t i = 0; i < 4; i++)
-                    ss << get_integral<int32_t>(0, 15);
-                ss << "-4";
+            /**
+             * @brief Generates a random(version 4) UUID out of two 64-bit draws.
+             * @note   
+             * @retval A random UUID
+             */
+            [[nodiscard]] uuid get_uuid_v4(void) noexcept {
+                const uint64_t high = XENON_HF_uuid_v4_high(XENON_HF_draw_64(m_generator));
+                return uuid(high, XENON_HF_uuid_low(XENON_HF_draw_64(m_generator)));
+            }
 
-                for (uint32_t i = 0; i < 3; i++)
-                    ss << get_integral<int32_t>(0, 15);
-                ss << "-";
+            /**
+             * @brief Generates a time-ordered(version 7) UUID: milliseconds since the Unix epoch followed by 74 random bits.
+             * @note   UUIDs of different milliseconds sort by time, which keeps database indices compact
+             * @retval A random UUID
+             */
+            [[nodiscard]] uuid get_uuid_v7(void) noexcept {
+                const uint64_t high = XENON_HF_uuid_v7_high(XENON_HF_draw_64(m_generator));
+                return uuid(high, XENON_HF_uuid_low(XENON_HF_draw_64(m_generator)));
+            }
 
-                ss << get_integral<int32_t>(8, 11);
-                for (uint32_t i = 0; i < 3; i++)
-                    ss << get_integral<int32_t>(0, 15);
-                ss << "-";
+            /**
+             * @brief Shuffles a buffer in place.
+             * @note   Every order is equally likely. Big buffers are shuffled with the swap targets prefetched ahead.
+             * @param  data: The buffer
+             * @retval None
+             */
+            template<typename T>
+            void shuffle(const std::span<T> data) noexcept {
+                XENON_HF_shuffle(m_generator, data);
+            }
+
+            /**
+             * @brief Picks an index of a weight with an alias_table.
+             * @note   O(1) no matter how many weights there are.
+             * @param  table: The table built from the weights
+             * @retval An index of a weight. 0 if the table is empty
+             */
+            [[nodiscard]] size_t get_weighted(const alias_table& table) noexcept {
+                return table.sample(*this);
+            }
+
+            /**
+             * @brief Picks k elements uniformly out of a sequence in one pass, without knowing its length.
+             * @note   Works with input iterators, such as stream iterators. Elements past the first k mostly get skipped without a draw. The order of the picked elements is unspecified.
+             * @param  first: Start of the sequence
+             * @param  last: End of the sequence
+             * @param  k: Amount of elements to pick
+             * @retval The picked elements, fewer than k if the sequence is shorter
+             */
+            template<std::input_iterator It, std::sentinel_for<It> S>
+            [[nodiscard]] std::vector<std::iter_value_t<It>> get_sample(It first, const S last, const size_t k) noexcept {
+                return XENON_HF_reservoir(m_generator, std::move(first), last, k);
+            }
 
-                for (uint32_t i = 0; i < 12; i++)
-                    ss << get_integral<int32_t>(0, 15);
-                return ss.str();
+            /**
+             * @brief Picks k elements uniformly out of a container or range in one pass.
+             * @note   Works with any range that has begin() and end(), including ones that are read lazily.
+             * @param  range: The range
+             * @param  k: Amount of elements to pick
+             * @retval The picked elements, fewer than k if the range is shorter
+             */
+            template<typename C>
+                requires xenon::concepts::has_iterator<std::remove_cvref_t<C>>
+            [[nodiscard]] auto get_sample(C&& range, const size_t k) noexcept {
+                return get_sample(range.begin(), range.end(), k);
             }
 
-            ~random_engine(void) noexcept = default;
+            ~basic_random_engine(void) noexcept = default;
         private:
-            std::unique_ptr<std::mt19937> gen;
+            G m_generator;
         };
+
+        /**
+         * @brief A random_engine with the default generator, xoshiro256**.
+         * @note   
+         */
+        using random_engine = basic_random_engine<xoshiro256ss>;
+
+        /**
+         * @brief Gets an engine that belongs to the calling thread, so it can be used without locking.
+         * @note   Every thread's engine is split from one process-wide engine, so no two threads draw the same numbers and std::random_device is asked only once.
+         * @retval The calling thread's engine
+         */
+        template<typename G = xoshiro256ss>
+            requires requires(G& gen) { gen.jump(); }
+        [[nodiscard]] inline basic_random_engine<G>& thread_local_engine(void) noexcept {
+            static thread_local basic_random_engine<G> engine = []() {
+                static std::mutex mutex;
+                static basic_random_engine<G> root;
+                std::lock_guard<std::mutex> lock(mutex);
+                return root.split();
+            }();
+            return engine;
+        }
     } // namespace random
 } // namespace xenon
 
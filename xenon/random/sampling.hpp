@@ -0,0 +1,246 @@
+// sampling.hpp
+//
+// Weighted sampling, shuffling and reservoir sampling that are a part of a Random module.
+
+#ifndef XENON_HG_RANDOM_SAMPLING
+#define XENON_HG_RANDOM_SAMPLING
+
+// Libraries
+#include <vector>
+#include <span>
+#include <iterator>
+#include <initializer_list>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+// Other parts of the Random component
+#include "fill.hpp"
+
+// Xenon's Dependencies
+#include "../concepts/concepts.hpp"
+
+#if defined(_MSC_VER) && defined(XENON_M_X86)
+#include <xmmintrin.h>
+#endif // defined(_MSC_VER) && defined(XENON_M_X86)
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    inline void XENON_HF_prefetch(const void* address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address, 1);
+#elif defined(_MSC_VER) && defined(XENON_M_X86)
+        _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+        static_cast<void>(address);
+#endif // defined(__GNUC__) || defined(__clang__)
+    }
+
+    /**
+     * @brief A random number in [0, bound) with Lemire's nearly divisionless method: the division only happens when the product lands in the biased part.
+     */
+    template<typename G>
+    inline uint64_t XENON_HF_below(G& gen, const uint64_t bound) noexcept {
+        if(bound <= 0x100000000) [[likely]] {
+            uint64_t product = (XENON_HF_draw_64(gen) >> 32) * bound;
+            if(static_cast<uint32_t>(product) < bound) [[unlikely]] {
+                const uint32_t threshold = static_cast<uint32_t>((0x100000000 - bound) % bound);
+                while(static_cast<uint32_t>(product) < threshold)
+                    product = (XENON_HF_draw_64(gen) >> 32) * bound;
+            }
+            return product >> 32;
+        }
+        uint64_t high, low;
+        XENON_HF_multiply_128(XENON_HF_draw_64(gen), bound, high, low);
+        if(low < bound) [[unlikely]] {
+            const uint64_t threshold = (0 - bound) % bound;
+            while(low < threshold)
+                XENON_HF_multiply_128(XENON_HF_draw_64(gen), bound, high, low);
+        }
+        return high;
+    }
+
+    /**
+     * @brief Fisher-Yates from the back. The swap targets are drawn a batch ahead and prefetched, so that big spans don't wait on a cache miss per element.
+     */
+    template<typename G, typename T>
+    inline void XENON_HF_shuffle(G& gen, const std::span<T> data) noexcept {
+        constexpr size_t batch = 64;
+        constexpr size_t distance = 8;
+        size_t targets[batch];
+        for(size_t i = data.size() > 0 ? data.size() - 1 : 0; i > 0;) {
+            const size_t count = std::min(batch, i);
+            for(size_t k = 0; k < count; ++k)
+                targets[k] = static_cast<size_t>(XENON_HF_below(gen, i - k + 1));
+            for(size_t k = 0; k < std::min(distance, count); ++k)
+                XENON_HF_prefetch(&data[targets[k]]);
+            for(size_t k = 0; k < count; ++k) {
+                if(k + distance < count)
+                    XENON_HF_prefetch(&data[targets[k + distance]]);
+                std::swap(data[i - k], data[targets[k]]);
+            }
+            i -= count;
+        }
+    }
+
+    /**
+     * @brief A uniform double in (0, 1], which is safe to take the logarithm of.
+     */
+    template<typename G>
+    inline double XENON_HF_open_unit(G& gen) noexcept {
+        return 1.0 - XENON_HF_unit_double(XENON_HF_draw_64(gen));
+    }
+
+    /**
+     * @brief Li's Algorithm L: after the reservoir is full, jumps over a geometrically distributed amount of elements instead of drawing for each one.
+     */
+    template<typename G, typename It, typename S>
+    inline std::vector<std::iter_value_t<It>> XENON_HF_reservoir(G& gen, It first, const S last, const size_t k) noexcept {
+        std::vector<std::iter_value_t<It>> reservoir;
+        if(k == 0) [[unlikely]]
+            return reservoir;
+        reservoir.reserve(k);
+        for(; first != last && reservoir.size() < k; ++first)
+            reservoir.emplace_back(*first);
+        if(first == last)
+            return reservoir;
+
+        double w = std::exp(std::log(XENON_HF_open_unit(gen)) / static_cast<double>(k));
+        for(;;) {
+            // Elements to pass over before the next one that goes in
+            const double skip = std::floor(std::log(XENON_HF_open_unit(gen)) / std::log1p(-w));
+            for(double i = 0; i < skip && first != last; ++i)
+                ++first;
+            if(first == last)
+                return reservoir;
+            reservoir[static_cast<size_t>(XENON_HF_below(gen, k))] = *first;
+            ++first;
+            if(first == last)
+                return reservoir;
+            w *= std::exp(std::log(XENON_HF_open_unit(gen)) / static_cast<double>(k));
+        }
+    }
+}
+
+namespace xenon {
+    namespace random {
+        /**
+         * @brief Picks indices with probabilities proportional to weights in O(1), with Walker's alias method(Vose's construction).
+         * @note   Building takes O(n). Every entry is 8 bytes and a pick reads one of them, so big tables stay cheap to sample.
+         */
+        class alias_table final {
+        public:
+            /**
+             * @brief Constructs an empty table.
+             * @note
+             */
+            alias_table(void) noexcept = default;
+
+            /**
+             * @brief Builds the table.
+             * @note   Negative weights count as 0. If every weight is 0 the table is empty.
+             * @param  weights: The weights
+             */
+            template<typename C>
+                requires xenon::concepts::has_iterator<C> && xenon::concepts::arithmetic<std::decay_t<decltype(*std::declval<const C&>().begin())>>
+            explicit alias_table(const C& weights) noexcept {
+                build(std::vector<double>(weights.begin(), weights.end()));
+            }
+
+            /**
+             * @brief Builds the table.
+             * @note   Negative weights count as 0. If every weight is 0 the table is empty.
+             * @param  weights: The weights
+             */
+            alias_table(const std::initializer_list<double> weights) noexcept {
+                build(std::vector<double>(weights));
+            }
+
+            /**
+             * @brief Picks an index.
+             * @note   Takes one 64-bit draw, apart from the rare draws that are rejected to keep it unbiased.
+             * @param  engine: The engine to draw from
+             * @retval An index of a weight. 0 if the table is empty
+             */
+            template<typename E>
+            [[nodiscard]] size_t sample(E& engine) const noexcept {
+                if(m_entries.empty()) [[unlikely]]
+                    return 0;
+                const uint64_t size = m_entries.size();
+                for(;;) {
+                    // The high half picks the column and the low half flips the coin
+                    const uint64_t bits = XENON_HF_draw_64(engine.generator());
+                    const uint64_t product = (bits >> 32) * size;
+                    if(static_cast<uint32_t>(product) < m_column_threshold) [[unlikely]]
+                        continue;
+                    const entry& column = m_entries[static_cast<size_t>(product >> 32)];
+                    return static_cast<uint32_t>(bits) < column.threshold ? static_cast<size_t>(product >> 32) : column.alias;
+                }
+            }
+
+            /**
+             * @brief Gets the amount of weights.
+             * @note
+             * @retval Amount of weights
+             */
+            [[nodiscard]] size_t size(void) const noexcept {
+                return m_entries.size();
+            }
+
+            /**
+             * @brief Checks whether the table has nothing to pick from.
+             * @note
+             * @retval True if empty
+             */
+            [[nodiscard]] bool empty(void) const noexcept {
+                return m_entries.empty();
+            }
+        private:
+            struct entry {
+                // The column's own index is kept when the low half of a draw is below this
+                uint32_t threshold;
+                uint32_t alias;
+            };
+
+            void build(std::vector<double> weights) noexcept {
+                double sum = 0;
+                for(double& weight : weights)
+                    sum += weight = std::max(weight, 0.0);
+                if(sum <= 0 || weights.size() > UINT32_MAX) [[unlikely]]
+                    return;
+
+                const size_t size = weights.size();
+                m_entries.resize(size);
+                m_column_threshold = static_cast<uint32_t>((0x100000000 - size) % size);
+                std::vector<uint32_t> small, large;
+                for(size_t i = 0; i < size; ++i) {
+                    weights[i] *= static_cast<double>(size) / sum;
+                    (weights[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+                }
+                while(!small.empty() && !large.empty()) {
+                    const uint32_t less = small.back(), more = large.back();
+                    small.pop_back();
+                    m_entries[less] = { static_cast<uint32_t>(weights[less] * 4294967296.0), more };
+                    weights[more] -= 1.0 - weights[less];
+                    if(weights[more] < 1.0) {
+                        large.pop_back();
+                        small.push_back(more);
+                    }
+                }
+                // Whatever is left is 1 up to rounding, so it always keeps its own index
+                for(const uint32_t i : large)
+                    m_entries[i] = { UINT32_MAX, i };
+                for(const uint32_t i : small)
+                    m_entries[i] = { UINT32_MAX, i };
+            }
+
+            std::vector<entry> m_entries;
+            uint32_t m_column_threshold = 0;
+        };
+    } // namespace random
+} // namespace xenon
+
+#endif // XENON_HG_RANDOM_SAMPLING
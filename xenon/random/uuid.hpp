@@ -0,0 +1,131 @@
+// uuid.hpp
+//
+// A UUID class that is a part of a Random module.
+
+#ifndef XENON_HG_RANDOM_UUID
+#define XENON_HG_RANDOM_UUID
+
+// Libraries
+#include <array>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace {
+    // -- Helper functions. Should not be used by the user. -- \\ 
+
+    /**
+     * @brief Two hex digits for every byte, so a byte is encoded with one lookup.
+     */
+    constexpr std::array<char, 512> XENON_HF_hex_pairs = []() {
+        constexpr char digits[] = "0123456789abcdef";
+        std::array<char, 512> table = {};
+        for(size_t byte = 0; byte < 256; ++byte) {
+            table[byte * 2] = digits[byte >> 4];
+            table[byte * 2 + 1] = digits[byte & 0xF];
+        }
+        return table;
+    }();
+
+    /**
+     * @brief Writes 128 bits as 8-4-4-4-12 hex digits. out has to have room for 36 characters.
+     */
+    inline void XENON_HF_format_uuid(const uint64_t high, const uint64_t low, char* out) noexcept {
+        for(size_t i = 0, position = 0; i < 16; ++i, position += 2) {
+            if(i == 4 || i == 6 || i == 8 || i == 10)
+                out[position++] = '-';
+            const size_t byte = static_cast<size_t>(((i < 8 ? high : low) >> (56 - (i % 8) * 8)) & 0xFF);
+            std::memcpy(out + position, &XENON_HF_hex_pairs[byte * 2], 2);
+        }
+    }
+
+    inline uint64_t XENON_HF_uuid_v4_high(const uint64_t random) noexcept {
+        return (random & ~uint64_t(0xF000)) | 0x4000;
+    }
+
+    inline uint64_t XENON_HF_uuid_v7_high(const uint64_t random) noexcept {
+        const uint64_t milliseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        return (milliseconds << 16) | 0x7000 | (random & 0xFFF);
+    }
+
+    inline uint64_t XENON_HF_uuid_low(const uint64_t random) noexcept {
+        return (random & 0x3FFFFFFFFFFFFFFF) | 0x8000000000000000;
+    }
+}
+
+namespace xenon {
+    namespace random {
+        /**
+         * @brief A UUID in its text form, stored inline so that making one doesn't allocate.
+         * @note
+         */
+        class uuid final {
+        public:
+            /**
+             * @brief Length of the text form.
+             * @note
+             */
+            static constexpr size_t length = 36;
+
+            /**
+             * @brief Constructs the nil UUID.
+             * @note
+             */
+            uuid(void) noexcept
+                : uuid(0, 0) {}
+
+            /**
+             * @brief Constructs a UUID from its 128 bits.
+             * @note
+             * @param  high: The first 64 bits
+             * @param  low: The last 64 bits
+             */
+            uuid(const uint64_t high, const uint64_t low) noexcept {
+                XENON_HF_format_uuid(high, low, m_text);
+                m_text[length] = '\0';
+            }
+
+            /**
+             * @brief Gets the text form.
+             * @note
+             * @retval A view of the 36 characters
+             */
+            [[nodiscard]] std::string_view view(void) const noexcept {
+                return { m_text, length };
+            }
+
+            /**
+             * @brief Gets the text form as a null-terminated string.
+             * @note
+             * @retval The string
+             */
+            [[nodiscard]] const char* c_str(void) const noexcept {
+                return m_text;
+            }
+
+            /**
+             * @brief Copies the text form into a std::string.
+             * @note
+             * @retval The string
+             */
+            [[nodiscard]] std::string str(void) const noexcept {
+                return std::string(view());
+            }
+
+            operator std::string_view(void) const noexcept {
+                return view();
+            }
+
+            [[nodiscard]] bool operator==(const uuid& other) const noexcept {
+                return view() == other.view();
+            }
+        private:
+            char m_text[length + 1];
+        };
+    } // namespace random
+} // namespace xenon
+
+#endif // XENON_HG_RANDOM_UUID
@@ -24,6 +24,17 @@ namespace xenon {
             ns
 		};
 
+        /**
+         * @brief Gets how many units of a time order make up one second.
+         * @note   1 for seconds, 1e9 for nanoseconds
+         * @param  time_order_: Time order(second, nanosecond, etc)
+         * @retval Units per second
+         */
+        [[nodiscard]] constexpr double time_order_scale(const time_order time_order_) noexcept {
+            constexpr double scales[] = { 1.0, 1e3, 1e6, 1e9 };
+            return scales[static_cast<int>(time_order_)];
+        }
+
         /**
          * @brief A type for all the time points that will be used.
          * @note
@@ -65,8 +76,8 @@ namespace xenon {
              * @param  time_order_: Time order(second, nanosecond, etc) 
              * @retval Duration in the specified time order
              */
-            [[nodiscard]] double get(const time_order time_order_ = time_order::s) noexcept {
-                return std::chrono::duration<double>(m_end - m_start).count() * (time_order_ == time_order::s ? 1 : pow(10, static_cast<int32_t>(time_order_) * 3));
+            [[nodiscard]] double get(const time_order time_order_ = time_order::s) const noexcept {
+                return std::chrono::duration<double>(m_end - m_start).count() * time_order_scale(time_order_);
             }
         private:
             timepoint_t m_start;
@@ -0,0 +1,274 @@
+// fast_clock.hpp
+//
+// A cycle-counter clock class that is a part of a Time module.
+
+#ifndef XENON_HG_TIME_FAST_CLOCK
+#define XENON_HG_TIME_FAST_CLOCK
+
+// Libraries
+#include <chrono>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Other parts of the Time component
+#include "clock.hpp"
+
+#include "../macros.hpp"
+
+#ifdef XENON_M_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif // _MSC_VER
+#endif // XENON_M_X86
+
+namespace xenon {
+    namespace time {
+        /**
+         * @brief A clock that reads the CPU's time stamp counter where it ticks at a constant rate, and steady_clock everywhere else.
+         * @note   The counter is calibrated against steady_clock once, the first time the clock is used, which takes about 10 milliseconds.
+         */
+        class fast_clock final {
+        public:
+            /**
+             * @brief Constructs the clock class and starts the timer.
+             * @note
+             */
+            fast_clock(void) noexcept
+                : m_start(now()), m_end(m_start) {}
+
+            /**
+             * @brief A default destructor.
+             * @note
+             */
+            ~fast_clock(void) noexcept = default;
+
+            /**
+             * @brief Starts the clock again.
+             * @note
+             * @retval None
+             */
+            void start(void) noexcept {
+                m_start = now();
+            }
+
+            /**
+             * @brief Ends the clock.
+             * @note   Waits for the measured instructions to finish before reading the counter
+             * @retval None
+             */
+            void stop(void) noexcept {
+                m_end = now_ordered();
+            }
+
+            /**
+             * @brief Gets the duration of the clock
+             * @note
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval Duration in the specified time order
+             */
+            [[nodiscard]] double get(const time_order time_order_ = time_order::s) const noexcept {
+                return to_seconds(m_end - m_start) * time_order_scale(time_order_);
+            }
+
+            /**
+             * @brief Reads the clock in ticks.
+             * @note
+             * @retval Ticks. Only differences between two reads mean anything
+             */
+            [[nodiscard]] static uint64_t now(void) noexcept {
+#ifdef XENON_M_X86
+                if(calibration().tsc) [[likely]]
+                    return __rdtsc();
+#endif // XENON_M_X86
+                return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            }
+
+            /**
+             * @brief Reads the clock in ticks after every instruction before it has finished.
+             * @note   Uses rdtscp where it's there. Meant for the end of a measurement
+             * @retval Ticks. Only differences between two reads mean anything
+             */
+            [[nodiscard]] static uint64_t now_ordered(void) noexcept {
+#ifdef XENON_M_X86
+                if(calibration().rdtscp) [[likely]] {
+                    uint32_t aux;
+                    return __rdtscp(&aux);
+                }
+#endif // XENON_M_X86
+                return now();
+            }
+
+            /**
+             * @brief Converts ticks into seconds.
+             * @note
+             * @param  ticks: A difference between two reads
+             * @retval Seconds
+             */
+            [[nodiscard]] static double to_seconds(const uint64_t ticks) noexcept {
+                return static_cast<double>(ticks) * calibration().seconds_per_tick;
+            }
+
+            /**
+             * @brief Converts ticks into nanoseconds.
+             * @note
+             * @param  ticks: A difference between two reads
+             * @retval Nanoseconds
+             */
+            [[nodiscard]] static std::chrono::nanoseconds to_duration(const uint64_t ticks) noexcept {
+                return std::chrono::nanoseconds(static_cast<int64_t>(to_seconds(ticks) * 1e9));
+            }
+
+            /**
+             * @brief Checks whether the clock reads the time stamp counter.
+             * @note
+             * @retval False if it falls back to steady_clock
+             */
+            [[nodiscard]] static bool is_tsc(void) noexcept {
+                return calibration().tsc;
+            }
+        private:
+            struct calibrated {
+                bool tsc = false;
+                bool rdtscp = false;
+                double seconds_per_tick = static_cast<double>(std::chrono::steady_clock::period::num) / std::chrono::steady_clock::period::den;
+            };
+
+            static const calibrated& calibration(void) noexcept {
+                static const calibrated result = calibrate();
+                return result;
+            }
+
+            static calibrated calibrate(void) noexcept {
+                calibrated result;
+#ifdef XENON_M_X86
+                // The counter is only usable as a clock when it's invariant: CPUID 0x80000007, EDX bit 8
+                uint32_t regs[4] = {};
+#ifdef _MSC_VER
+                int32_t info[4];
+                __cpuid(info, static_cast<int32_t>(0x80000000));
+                if(static_cast<uint32_t>(info[0]) >= 0x80000007u) {
+                    __cpuid(info, static_cast<int32_t>(0x80000001));
+                    regs[3] = static_cast<uint32_t>(info[3]);
+                    result.rdtscp = (regs[3] >> 27) & 1;
+                    __cpuid(info, static_cast<int32_t>(0x80000007));
+                    result.tsc = (static_cast<uint32_t>(info[3]) >> 8) & 1;
+                }
+#else
+                if(__get_cpuid_max(0x80000000u, nullptr) >= 0x80000007u) {
+                    __get_cpuid(0x80000001u, &regs[0], &regs[1], &regs[2], &regs[3]);
+                    result.rdtscp = (regs[3] >> 27) & 1;
+                    __get_cpuid(0x80000007u, &regs[0], &regs[1], &regs[2], &regs[3]);
+                    result.tsc = (regs[3] >> 8) & 1;
+                }
+#endif // _MSC_VER
+                if(!result.tsc) [[unlikely]] {
+                    result.rdtscp = false;
+                    return result;
+                }
+
+                // Spins instead of sleeping so that the window isn't stretched by the scheduler
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                const uint64_t start_ticks = __rdtsc();
+                std::chrono::steady_clock::time_point end;
+                do
+                    end = std::chrono::steady_clock::now();
+                while(end - start < std::chrono::milliseconds(10));
+                const uint64_t end_ticks = __rdtsc();
+                result.seconds_per_tick = std::chrono::duration<double>(end - start).count() / static_cast<double>(end_ticks - start_ticks);
+#endif // XENON_M_X86
+                return result;
+            }
+
+            uint64_t m_start;
+            uint64_t m_end;
+        };
+
+        /**
+         * @brief A clock that records laps into a buffer that is allocated up front. Starts when constructed.
+         * @note   Reads fast_clock, so recording a lap costs one counter read and one store.
+         */
+        template<size_t N = 64>
+        class lap_clock final {
+        public:
+            /**
+             * @brief Constructs the clock class and starts the timer.
+             * @note
+             */
+            lap_clock(void) noexcept
+                : m_start(fast_clock::now()) {}
+
+            /**
+             * @brief A default destructor.
+             * @note
+             */
+            ~lap_clock(void) noexcept = default;
+
+            /**
+             * @brief Forgets every lap and starts the clock again.
+             * @note
+             * @retval None
+             */
+            void reset(void) noexcept {
+                m_count = 0;
+                m_start = fast_clock::now();
+            }
+
+            /**
+             * @brief Ends the current lap and starts the next one.
+             * @note
+             * @retval False if the buffer is full and the lap wasn't recorded
+             */
+            bool lap(void) noexcept {
+                if(m_count == N) [[unlikely]]
+                    return false;
+                m_marks[m_count++] = fast_clock::now_ordered();
+                return true;
+            }
+
+            /**
+             * @brief Gets the amount of recorded laps.
+             * @note
+             * @retval Amount of laps
+             */
+            [[nodiscard]] size_t laps(void) const noexcept {
+                return m_count;
+            }
+
+            /**
+             * @brief Gets the duration of one lap.
+             * @note
+             * @param  index: Index of the lap, 0 is the first one
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval Duration in the specified time order
+             */
+            [[nodiscard]] double get_lap(const size_t index, const time_order time_order_ = time_order::s) const noexcept {
+                return scale(m_marks[index] - (index == 0 ? m_start : m_marks[index - 1]), time_order_);
+            }
+
+            /**
+             * @brief Gets the time from the start to the end of a lap.
+             * @note
+             * @param  index: Index of the lap, 0 is the first one
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval Duration in the specified time order
+             */
+            [[nodiscard]] double get_split(const size_t index, const time_order time_order_ = time_order::s) const noexcept {
+                return scale(m_marks[index] - m_start, time_order_);
+            }
+        private:
+            static double scale(const uint64_t ticks, const time_order time_order_) noexcept {
+                return fast_clock::to_seconds(ticks) * time_order_scale(time_order_);
+            }
+
+            uint64_t m_start;
+            size_t m_count = 0;
+            std::array<uint64_t, N> m_marks;
+        };
+    } // namespace time
+} // namespace xenon
+
+#endif // XENON_HG_TIME_FAST_CLOCK
@@ -0,0 +1,306 @@
+// histogram.hpp
+//
+// A latency histogram class that is a part of a Time module.
+
+#ifndef XENON_HG_TIME_HISTOGRAM
+#define XENON_HG_TIME_HISTOGRAM
+
+// Libraries
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+// Other parts of the Time component
+#include "clock.hpp"
+#include "fast_clock.hpp"
+
+namespace xenon {
+    namespace time {
+        /**
+         * @brief A copy of a histogram's counts that answers percentile queries. Snapshots of different histograms can be merged.
+         * @note   Values are reported in the middle of their bucket, clamped to the recorded minimum and maximum.
+         */
+        class histogram_snapshot final {
+        public:
+            /**
+             * @brief Gets the amount of recorded values.
+             * @note
+             * @retval Amount of values
+             */
+            [[nodiscard]] uint64_t count(void) const noexcept {
+                return m_cumulative.empty() ? 0 : m_cumulative.back();
+            }
+
+            /**
+             * @brief Gets the smallest recorded value.
+             * @note
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval The value in the specified time order. 0 if nothing was recorded
+             */
+            [[nodiscard]] double min(const time_order time_order_ = time_order::s) const noexcept {
+                return count() == 0 ? 0 : scale(static_cast<double>(m_min), time_order_);
+            }
+
+            /**
+             * @brief Gets the biggest recorded value.
+             * @note
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval The value in the specified time order
+             */
+            [[nodiscard]] double max(const time_order time_order_ = time_order::s) const noexcept {
+                return scale(static_cast<double>(m_max), time_order_);
+            }
+
+            /**
+             * @brief Gets the mean of the recorded values.
+             * @note   Computed from the exact sum, not from the buckets.
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval The value in the specified time order
+             */
+            [[nodiscard]] double mean(const time_order time_order_ = time_order::s) const noexcept {
+                return count() == 0 ? 0 : scale(static_cast<double>(m_sum) / static_cast<double>(count()), time_order_);
+            }
+
+            /**
+             * @brief Gets the value that the specified share of recorded values are less or equal to.
+             * @note   Takes the same time no matter how many values were recorded: a binary search over the fixed amount of buckets.
+             * @param  p: The percentile in [0, 100], e.g. 99.9
+             * @param  time_order_: Time order(second, nanosecond, etc)
+             * @retval The value in the specified time order
+             */
+            [[nodiscard]] double percentile(const double p, const time_order time_order_ = time_order::s) const noexcept;
+
+            /**
+             * @brief Adds the counts of another snapshot to this one.
+             * @note
+             * @param  other: The other snapshot
+             * @retval None
+             */
+            void merge(const histogram_snapshot& other) noexcept;
+        private:
+            friend class histogram;
+
+            static double scale(const double nanoseconds, const time_order time_order_) noexcept {
+                return nanoseconds * (time_order_scale(time_order_) / time_order_scale(time_order::ns));
+            }
+
+            // Running total of the counts, so the last element is the amount of values
+            std::vector<uint64_t> m_cumulative;
+            uint64_t m_min = UINT64_MAX;
+            uint64_t m_max = 0;
+            uint64_t m_sum = 0;
+        };
+
+        /**
+         * @brief A log-linear(HDR-style) histogram of durations with a fixed amount of memory, no matter how many values are recorded.
+         * @note   Durations are kept in nanoseconds with a relative error below 1 / 2^(sub_bucket_bits - 1), that is 0.8%, up to about 584 years.
+         *         Recording is lock-free and can be done from many threads at once. Threads that record millions of values per second should each have their own histogram and merge the snapshots.
+         */
+        class histogram final {
+        public:
+            /**
+             * @brief Amount of bits of a value that are kept in every power of two. Values below 2^sub_bucket_bits nanoseconds are exact.
+             * @note
+             */
+            static constexpr uint32_t sub_bucket_bits = 8;
+
+            /**
+             * @brief Amount of buckets, each one is a 64-bit counter.
+             * @note
+             */
+            static constexpr size_t bucket_count = (66 - sub_bucket_bits) << (sub_bucket_bits - 1);
+
+            /**
+             * @brief Constructs the histogram and allocates all of its buckets.
+             * @note
+             */
+            histogram(void) noexcept
+                : m_buckets(std::make_unique<std::atomic<uint64_t>[]>(bucket_count)) {}
+
+            /**
+             * @brief A default destructor.
+             * @note
+             */
+            ~histogram(void) noexcept = default;
+
+            histogram(const histogram&) = delete;
+            histogram& operator=(const histogram&) = delete;
+
+            /**
+             * @brief Records a duration.
+             * @note
+             * @param  nanoseconds: The duration in nanoseconds
+             * @param  times: How many times to record it
+             * @retval None
+             */
+            void record(const uint64_t nanoseconds, const uint64_t times = 1) noexcept {
+                m_buckets[bucket_index(nanoseconds)].fetch_add(times, std::memory_order_relaxed);
+                m_sum.fetch_add(nanoseconds * times, std::memory_order_relaxed);
+                for(uint64_t min = m_min.load(std::memory_order_relaxed); nanoseconds < min && !m_min.compare_exchange_weak(min, nanoseconds, std::memory_order_relaxed););
+                for(uint64_t max = m_max.load(std::memory_order_relaxed); nanoseconds > max && !m_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed););
+            }
+
+            /**
+             * @brief Records a duration.
+             * @note
+             * @param  duration: The duration
+             * @retval None
+             */
+            template<typename Rep, typename Period>
+            void record(const std::chrono::duration<Rep, Period> duration) noexcept {
+                const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+                record(static_cast<uint64_t>(std::max<int64_t>(nanoseconds, 0)));
+            }
+
+            /**
+             * @brief Records a duration that was measured in some time order, e.g. what clock::get returned.
+             * @note
+             * @param  value: The duration
+             * @param  time_order_: Time order(second, nanosecond, etc) of the value
+             * @retval None
+             */
+            void record(const double value, const time_order time_order_) noexcept {
+                const double nanoseconds = value * (time_order_scale(time_order::ns) / time_order_scale(time_order_));
+                record(nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds + 0.5) : uint64_t(0));
+            }
+
+            /**
+             * @brief Records the duration of a stopped clock.
+             * @note
+             * @param  clock_: The clock
+             * @retval None
+             */
+            void record(const clock& clock_) noexcept {
+                record(clock_.get(time_order::ns), time_order::ns);
+            }
+
+            /**
+             * @brief Records the duration of a stopped clock.
+             * @note
+             * @param  clock_: The clock
+             * @retval None
+             */
+            void record(const fast_clock& clock_) noexcept {
+                record(clock_.get(time_order::ns), time_order::ns);
+            }
+
+            /**
+             * @brief Adds the counts of a snapshot, e.g. one of another histogram.
+             * @note
+             * @param  other: The snapshot
+             * @retval None
+             */
+            void merge(const histogram_snapshot& other) noexcept {
+                for(size_t i = 0; i < other.m_cumulative.size(); ++i)
+                    if(const uint64_t count = other.m_cumulative[i] - (i == 0 ? 0 : other.m_cumulative[i - 1]); count != 0)
+                        m_buckets[i].fetch_add(count, std::memory_order_relaxed);
+                m_sum.fetch_add(other.m_sum, std::memory_order_relaxed);
+                for(uint64_t min = m_min.load(std::memory_order_relaxed); other.m_min < min && !m_min.compare_exchange_weak(min, other.m_min, std::memory_order_relaxed););
+                for(uint64_t max = m_max.load(std::memory_order_relaxed); other.m_max > max && !m_max.compare_exchange_weak(max, other.m_max, std::memory_order_relaxed););
+            }
+
+            /**
+             * @brief Copies the counts so that they can be queried.
+             * @note   Values that are recorded while the copy is made may or may not be in it.
+             * @retval The snapshot
+             */
+            [[nodiscard]] histogram_snapshot snapshot(void) const noexcept {
+                histogram_snapshot copy;
+                copy.m_cumulative.resize(bucket_count);
+                uint64_t total = 0;
+                for(size_t i = 0; i < bucket_count; ++i)
+                    copy.m_cumulative[i] = total += m_buckets[i].load(std::memory_order_relaxed);
+                copy.m_min = m_min.load(std::memory_order_relaxed);
+                copy.m_max = m_max.load(std::memory_order_relaxed);
+                copy.m_sum = m_sum.load(std::memory_order_relaxed);
+                return copy;
+            }
+
+            /**
+             * @brief Forgets every recorded value.
+             * @note   Values that are recorded at the same time may partially survive.
+             * @retval None
+             */
+            void reset(void) noexcept {
+                for(size_t i = 0; i < bucket_count; ++i)
+                    m_buckets[i].store(0, std::memory_order_relaxed);
+                m_min.store(UINT64_MAX, std::memory_order_relaxed);
+                m_max.store(0, std::memory_order_relaxed);
+                m_sum.store(0, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Gets the bucket that a value goes into.
+             * @note   Values below 2^sub_bucket_bits have a bucket each. Above that, every power of two is split into 2^(sub_bucket_bits - 1) buckets.
+             * @param  nanoseconds: The value
+             * @retval Index of the bucket
+             */
+            [[nodiscard]] static constexpr size_t bucket_index(const uint64_t nanoseconds) noexcept {
+                const uint32_t shift = static_cast<uint32_t>(std::max<int32_t>(std::bit_width(nanoseconds) - static_cast<int32_t>(sub_bucket_bits), 0));
+                return (static_cast<size_t>(shift) << (sub_bucket_bits - 1)) + static_cast<size_t>(nanoseconds >> shift);
+            }
+
+            /**
+             * @brief Gets the smallest value that goes into a bucket.
+             * @note
+             * @param  index: Index of the bucket
+             * @retval The value in nanoseconds
+             */
+            [[nodiscard]] static constexpr uint64_t bucket_lowest(const size_t index) noexcept {
+                constexpr size_t half = size_t(1) << (sub_bucket_bits - 1);
+                if(index < 2 * half)
+                    return index;
+                const size_t shift = index / half - 1;
+                return static_cast<uint64_t>(index - shift * half) << shift;
+            }
+
+            /**
+             * @brief Gets the biggest value that goes into a bucket.
+             * @note
+             * @param  index: Index of the bucket
+             * @retval The value in nanoseconds
+             */
+            [[nodiscard]] static constexpr uint64_t bucket_highest(const size_t index) noexcept {
+                constexpr size_t half = size_t(1) << (sub_bucket_bits - 1);
+                return index < 2 * half ? index : bucket_lowest(index) + ((uint64_t(1) << (index / half - 1)) - 1);
+            }
+        private:
+            std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+            std::atomic<uint64_t> m_min = UINT64_MAX;
+            std::atomic<uint64_t> m_max = 0;
+            std::atomic<uint64_t> m_sum = 0;
+        };
+
+        inline double histogram_snapshot::percentile(const double p, const time_order time_order_) const noexcept {
+            const uint64_t total = count();
+            if(total == 0) [[unlikely]]
+                return 0;
+            // The rank of the wanted value, counting from 1
+            const uint64_t rank = std::clamp<uint64_t>(static_cast<uint64_t>(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(total) + 0.5), 1, total);
+            const size_t index = static_cast<size_t>(std::lower_bound(m_cumulative.begin(), m_cumulative.end(), rank) - m_cumulative.begin());
+            const uint64_t lowest = histogram::bucket_lowest(index);
+            const uint64_t middle = lowest + (histogram::bucket_highest(index) - lowest) / 2;
+            // The minimum and maximum can lag behind the buckets when the snapshot was taken during a record
+            return scale(static_cast<double>(m_min <= m_max ? std::clamp(middle, m_min, m_max) : middle), time_order_);
+        }
+
+        inline void histogram_snapshot::merge(const histogram_snapshot& other) noexcept {
+            if(other.count() == 0) [[unlikely]]
+                return;
+            if(m_cumulative.empty())
+                m_cumulative.resize(other.m_cumulative.size());
+            for(size_t i = 0; i < m_cumulative.size(); ++i)
+                m_cumulative[i] += other.m_cumulative[i];
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+            m_sum += other.m_sum;
+        }
+    } // namespace time
+} // namespace xenon
+
+#endif // XENON_HG_TIME_HISTOGRAM
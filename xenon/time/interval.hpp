@@ -5,54 +5,112 @@
 #ifndef XENON_HG_TIME_INTERVAL
 #define XENON_HG_TIME_INTERVAL
 
+// Libraries
+#include <atomic>
+#include <memory>
+#include <tuple>
+#include <thread>
+#include <chrono>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+
+// Other parts of the Time component
+#include "scheduler.hpp"
+
 // Dependencies
 #include "../async/async.hpp"
 
 namespace xenon {
     namespace time {
         /**
-         * @brief An interval class that will be used in a time module  
+         * @brief What an interval does with deadlines that passed while its function was running late.
+         * @note   
+         */
+        enum class catch_up {
+            // Drop the missed calls and continue with the next deadline that is still ahead
+            skip,
+            // Make every missed call back to back until the interval is on time again
+            burst,
+            // Make one call for all of the missed ones right away, then continue with the next deadline that is still ahead
+            coalesce
+        };
+
+        /**
+         * @brief Statistics about how late an interval's calls started compared to their deadlines.
          * @note   
          */
+        struct interval_stats {
+            // Amount of calls that were made
+            uint64_t ticks;
+            // Amount of deadlines that were dropped by skip or merged by coalesce
+            uint64_t missed;
+            // Lateness of the most recent call
+            std::chrono::nanoseconds last_lateness;
+            // Average lateness of all the calls
+            std::chrono::nanoseconds mean_lateness;
+            // Biggest lateness of all the calls
+            std::chrono::nanoseconds max_lateness;
+        };
+
+        /**
+         * @brief An interval class that will be used in a time module  
+         * @note   Calls are scheduled against absolute deadlines on a steady clock, so the period doesn't drift by however long the function takes.
+         *         Calls never overlap. Asynchronous intervals are timers of the default scheduler, so they don't hold a thread while they wait.
+         */
         template<typename F, typename... Args>
             requires xenon::concepts::callable<F, Args...>
         class interval {
         public:
             /**
              * @brief Constructs the interval class.  
-             * @note   
+             * @note   A synchronous interval blocks until it is stopped.
              * @param  func: The functon
              * @param  timeout: The timeout
              * @param  async: Whether it is asynchronous or not 
+             * @param  policy: What to do with deadlines that were missed
              * @param  args: Args
              */
-            explicit interval(F&& func, const uint32_t timeout, const bool async, Args&&... args) noexcept
-                : m_func(std::forward<F>(func)), m_timeout(timeout), m_async(async) {
-                const auto function = [&]() {
+            explicit interval(F&& func, const uint32_t timeout, const bool async, const catch_up policy, Args&&... args) noexcept
+                : m_state(std::make_shared<state>(std::forward<F>(func), timeout, policy, std::forward<Args>(args)...)), m_async(async) {
+                m_state->next = std::chrono::steady_clock::now() + m_state->period;
+                if(m_async)
+                    state::arm(m_state);
+                else
                     for(;;) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(m_timeout));
-                        if(m_running == 1)
-                            m_func(std::forward<Args>(args)...);
-                        else
+                        std::this_thread::sleep_until(m_state->next);
+                        if(m_state->running.load(std::memory_order_acquire) == -1)
                             break;
+                        m_state->tick();
                     }
-                };
-                m_async ? xenon::async::run(function, std::forward<Args>(args)...) : function(std::forward<Args>(args)...);
             }
 
             /**
-             * @brief A default destructor.  
+             * @brief Constructs the interval class that skips missed deadlines.  
+             * @note   A synchronous interval blocks until it is stopped.
+             * @param  func: The functon
+             * @param  timeout: The timeout
+             * @param  async: Whether it is asynchronous or not 
+             * @param  args: Args
+             */
+            explicit interval(F&& func, const uint32_t timeout, const bool async, Args&&... args) noexcept
+                : interval(std::forward<F>(func), timeout, async, catch_up::skip, std::forward<Args>(args)...) {}
+
+            /**
+             * @brief Stops the interval.  
              * @note   
              */
-            ~interval(void) noexcept = default;
+            ~interval(void) noexcept {
+                stop();
+            }
 
             /**
              * @brief Pauses the interval class
-             * @note   
+             * @note   Deadlines keep passing while paused, so resuming stays on the same cadence
              * @retval None
              */
             void pause(void) noexcept {
-                m_running = 0;
+                m_state->running.store(0, std::memory_order_release);
             }
 
             /**
@@ -61,21 +119,94 @@ namespace xenon {
              * @retval None
              */
             void resume(void) noexcept {
-                m_running = 1;
+                m_state->running.store(1, std::memory_order_release);
             }
 
             /**
              * @brief Stops the interval class
-             * @note   
+             * @note   Takes effect immediately: no call starts after this returns. A call that has already started finishes
              * @retval None
              */
             void stop(void) noexcept {
-                m_running = -1;
+                m_state->running.store(-1, std::memory_order_release);
+                if(m_async)
+                    xenon::time::default_scheduler().cancel(m_state->timer.load(std::memory_order_acquire));
+            }
+
+            /**
+             * @brief Gets the lateness statistics of the calls so far.
+             * @note   
+             * @retval The statistics
+             */
+            [[nodiscard]] interval_stats stats(void) const noexcept {
+                const uint64_t ticks = m_state->ticks.load(std::memory_order_relaxed);
+                return interval_stats{
+                    ticks,
+                    m_state->missed.load(std::memory_order_relaxed),
+                    std::chrono::nanoseconds(m_state->last_lateness.load(std::memory_order_relaxed)),
+                    std::chrono::nanoseconds(ticks == 0 ? 0 : m_state->total_lateness.load(std::memory_order_relaxed) / static_cast<int64_t>(ticks)),
+                    std::chrono::nanoseconds(m_state->max_lateness.load(std::memory_order_relaxed))
+                };
             }
         private:
-            int32_t m_running = 1;
-            uint32_t m_timeout = 1000;
-            F m_func;
+            // Shared with the scheduled callback, so a tick that is already running outlives the interval
+            struct state {
+                std::decay_t<F> func;
+                std::tuple<std::decay_t<Args>...> args;
+                std::atomic<int32_t> running = 1;
+                std::atomic<xenon::time::timer_id> timer = 0;
+                const std::chrono::steady_clock::duration period;
+                const catch_up policy;
+                // Only touched by the one tick that is running
+                std::chrono::steady_clock::time_point next;
+
+                std::atomic<uint64_t> ticks = 0;
+                std::atomic<uint64_t> missed = 0;
+                std::atomic<int64_t> last_lateness = 0;
+                std::atomic<int64_t> total_lateness = 0;
+                std::atomic<int64_t> max_lateness = 0;
+
+                state(F&& func_, const uint32_t timeout, const catch_up policy_, Args&&... args_) noexcept
+                    : func(std::forward<F>(func_)), args(std::forward<Args>(args_)...), period(std::chrono::milliseconds(std::max(1u, timeout))), policy(policy_) {}
+
+                static void arm(const std::shared_ptr<state>& self) noexcept {
+                    if(self->running.load(std::memory_order_acquire) == -1) [[unlikely]]
+                        return;
+                    self->timer.store(xenon::time::default_scheduler().schedule_at(self->next, [self]() {
+                        if(self->running.load(std::memory_order_acquire) == -1) [[unlikely]]
+                            return;
+                        self->tick();
+                        arm(self);
+                    }), std::memory_order_release);
+                }
+
+                void tick(void) noexcept {
+                    if(running.load(std::memory_order_acquire) == 1) [[likely]] {
+                        const int64_t lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - next).count();
+                        // Ticks never overlap, so the statistics have one writer and only need to be atomic for readers
+                        ticks.store(ticks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        last_lateness.store(lateness, std::memory_order_relaxed);
+                        total_lateness.store(total_lateness.load(std::memory_order_relaxed) + lateness, std::memory_order_relaxed);
+                        if(lateness > max_lateness.load(std::memory_order_relaxed))
+                            max_lateness.store(lateness, std::memory_order_relaxed);
+                        std::apply(func, args);
+                    }
+                    advance(std::chrono::steady_clock::now());
+                }
+
+                void advance(const std::chrono::steady_clock::time_point now) noexcept {
+                    next += period;
+                    if(next > now || policy == catch_up::burst) [[likely]]
+                        return;
+                    // Deadlines that have already passed, including next itself
+                    const uint64_t behind = static_cast<uint64_t>((now - next) / period) + 1;
+                    const uint64_t dropped = policy == catch_up::skip ? behind : behind - 1;
+                    missed.fetch_add(dropped, std::memory_order_relaxed);
+                    next += period * static_cast<int64_t>(dropped);
+                }
+            };
+
+            std::shared_ptr<state> m_state;
             bool m_async;
         };
     } // namespace time
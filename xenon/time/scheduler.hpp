@@ -0,0 +1,388 @@
+// scheduler.hpp
+//
+// A timer scheduler class that is a part of a Time module.
+
+#ifndef XENON_HG_TIME_SCHEDULER
+#define XENON_HG_TIME_SCHEDULER
+
+// Libraries
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Dependencies
+#include "../async/thread_pool.hpp"
+#include "../concepts/concepts.hpp"
+
+namespace xenon {
+    namespace time {
+        /**
+         * @brief An identifier of a scheduled timer that can be used to cancel it.
+         * @note   0 is never a valid identifier.
+         */
+        using timer_id = uint64_t;
+
+        /**
+         * @brief Runs timers from one thread with a hierarchical timer wheel and hands expired callbacks to a thread pool.
+         * @note   The wheel ticks every millisecond. Level 0 has 256 slots of one tick, and each of the 3 levels above it has 64 slots that are 64 times coarser.
+         *         Timers further away than the wheel reaches(about 18 hours) wait in the last level and get placed again when it comes around.
+         *         Scheduling and cancelling are O(1) and the thread sleeps until the next occupied slot instead of waking up every tick.
+         */
+        class timer_scheduler final {
+        public:
+            /**
+             * @brief Constructs the scheduler and starts its thread.
+             * @note
+             * @param  pool: The pool that the callbacks run on
+             */
+            explicit timer_scheduler(xenon::async::thread_pool& pool = xenon::async::default_pool()) noexcept
+                : m_pool(pool), m_start(std::chrono::steady_clock::now()) {
+                for(uint32_t& head : m_slots)
+                    head = none;
+                m_thread = std::thread([this]() { run(); });
+            }
+
+            /**
+             * @brief Stops the thread. Timers that haven't expired are dropped.
+             * @note
+             */
+            ~timer_scheduler(void) noexcept {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_cv.notify_one();
+                m_thread.join();
+            }
+
+            timer_scheduler(const timer_scheduler&) = delete;
+            timer_scheduler& operator=(const timer_scheduler&) = delete;
+
+            /**
+             * @brief Runs a function once after some time.
+             * @note   The function never runs before delay milliseconds have passed.
+             * @param  delay: After how many milliseconds to run the function
+             * @param  func: The function
+             * @retval An identifier to cancel the timer with
+             */
+            template<typename F>
+                requires xenon::concepts::callable<F>
+            timer_id schedule(const uint32_t delay, F&& func) noexcept {
+                return add(delay_tick(delay), 0, xenon::async::job(std::forward<F>(func)), nullptr);
+            }
+
+            /**
+             * @brief Runs a function once at a point in time. The function never runs before it.
+             * @note
+             * @param  deadline: When to run the function
+             * @param  func: The function
+             * @retval An identifier to cancel the timer with
+             */
+            template<typename F>
+                requires xenon::concepts::callable<F>
+            timer_id schedule_at(const std::chrono::steady_clock::time_point deadline, F&& func) noexcept {
+                return add(deadline_tick(deadline), 0, xenon::async::job(std::forward<F>(func)), nullptr);
+            }
+
+            /**
+             * @brief Runs a function every period until the timer is cancelled.
+             * @note   Expirations are counted from the first deadline, so a slow callback doesn't shift the ones after it.
+             *         Calls never overlap: an expiration that comes while the previous call is still running is skipped.
+             * @param  period: The amount of milliseconds between each call
+             * @param  func: The function
+             * @retval An identifier to cancel the timer with
+             */
+            template<typename F>
+                requires xenon::concepts::callable<F>
+            timer_id schedule_every(const uint32_t period, F&& func) noexcept {
+                return add(delay_tick(period), std::max(1u, period), xenon::async::job(), std::make_shared<periodic>(std::forward<F>(func)));
+            }
+
+            /**
+             * @brief Cancels a timer. A callback that is already running is not interrupted.
+             * @note
+             * @param  id: The identifier of the timer
+             * @retval True if the timer was still scheduled
+             */
+            bool cancel(const timer_id id) noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const uint32_t index = static_cast<uint32_t>(id >> 32);
+                if(index >= m_nodes.size() || m_nodes[index].generation != static_cast<uint32_t>(id) || m_nodes[index].slot == none) [[unlikely]]
+                    return false;
+                unlink(index);
+                release(index);
+                return true;
+            }
+
+            /**
+             * @brief Gets the amount of timers that are scheduled.
+             * @note
+             * @retval Amount of timers
+             */
+            [[nodiscard]] size_t pending(void) noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_count;
+            }
+
+            /**
+             * @brief Gets how much memory the timers take up, including nodes that are free for reuse.
+             * @note
+             * @retval Bytes
+             */
+            [[nodiscard]] size_t memory_usage(void) noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return sizeof(*this) + m_nodes.capacity() * sizeof(node);
+            }
+        private:
+            static constexpr uint32_t none = static_cast<uint32_t>(-1);
+            static constexpr uint32_t level0_bits = 8;
+            static constexpr uint32_t level_bits = 6;
+            static constexpr uint32_t levels = 4;
+            static constexpr uint32_t level0_slots = 1u << level0_bits;
+            static constexpr uint32_t level_slots = 1u << level_bits;
+            static constexpr uint64_t max_delta = 1ull << (level0_bits + level_bits * (levels - 1));
+
+            struct periodic {
+                template<typename F>
+                explicit periodic(F&& func) noexcept
+                    : func(std::forward<F>(func)) {}
+
+                xenon::async::job func;
+                // Set while a call is queued or running
+                std::atomic<bool> running = false;
+            };
+
+            struct node {
+                uint64_t expiry = 0;
+                uint32_t prev = none;
+                uint32_t next = none;
+                uint32_t slot = none;
+                uint32_t generation = 1;
+                uint32_t period = 0;
+                xenon::async::job once;
+                std::shared_ptr<periodic> every;
+            };
+
+            [[nodiscard]] uint64_t now_tick(void) const noexcept {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count());
+            }
+
+            /**
+             * @brief The tick delay milliseconds from now. now_tick() rounds down, so one more tick keeps the timer from firing early.
+             */
+            [[nodiscard]] uint64_t delay_tick(const uint32_t delay) const noexcept {
+                return now_tick() + delay + 1;
+            }
+
+            [[nodiscard]] uint64_t deadline_tick(const std::chrono::steady_clock::time_point deadline) const noexcept {
+                if(deadline <= m_start) [[unlikely]]
+                    return 0;
+                return static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(deadline - m_start).count());
+            }
+
+            timer_id add(const uint64_t expiry, const uint32_t period, xenon::async::job&& once, std::shared_ptr<periodic>&& every) noexcept {
+                bool wake;
+                timer_id id;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    uint32_t index;
+                    if(m_free != none) [[likely]] {
+                        index = m_free;
+                        m_free = m_nodes[index].next;
+                    } else [[unlikely]] {
+                        index = static_cast<uint32_t>(m_nodes.size());
+                        m_nodes.emplace_back();
+                    }
+                    // Without any timers there's nothing to cascade, so the wheel can skip the ticks it slept through
+                    if(m_count == 0)
+                        m_tick = std::max(m_tick, now_tick());
+                    node& timer = m_nodes[index];
+                    timer.expiry = std::max(expiry, m_tick);
+                    timer.period = period;
+                    timer.once = std::move(once);
+                    timer.every = std::move(every);
+                    place(index);
+                    ++m_count;
+                    id = (static_cast<uint64_t>(index) << 32) | timer.generation;
+                    wake = timer.expiry < m_wakeup;
+                }
+                if(wake)
+                    m_cv.notify_one();
+                return id;
+            }
+
+            void release(const uint32_t index) noexcept {
+                node& timer = m_nodes[index];
+                timer.once = xenon::async::job();
+                timer.every.reset();
+                timer.slot = none;
+                timer.prev = none;
+                timer.next = m_free;
+                // Generation 0 would make an identifier of 0 possible
+                if(++timer.generation == 0) [[unlikely]]
+                    timer.generation = 1;
+                m_free = index;
+                --m_count;
+            }
+
+            void place(const uint32_t index) noexcept {
+                node& timer = m_nodes[index];
+                const uint64_t expiry = std::min(timer.expiry, m_tick + max_delta - 1);
+                const uint64_t delta = expiry - m_tick;
+                uint32_t slot;
+                if(delta < level0_slots) [[likely]]
+                    slot = static_cast<uint32_t>(expiry & (level0_slots - 1));
+                else {
+                    uint32_t level = 1;
+                    while(delta >= (1ull << (level0_bits + level_bits * level)))
+                        ++level;
+                    const uint32_t shift = level0_bits + level_bits * (level - 1);
+                    slot = level0_slots + (level - 1) * level_slots + static_cast<uint32_t>((expiry >> shift) & (level_slots - 1));
+                }
+                timer.slot = slot;
+                timer.prev = none;
+                timer.next = m_slots[slot];
+                if(timer.next != none)
+                    m_nodes[timer.next].prev = index;
+                m_slots[slot] = index;
+            }
+
+            void unlink(const uint32_t index) noexcept {
+                node& timer = m_nodes[index];
+                if(timer.prev != none)
+                    m_nodes[timer.prev].next = timer.next;
+                else
+                    m_slots[timer.slot] = timer.next;
+                if(timer.next != none)
+                    m_nodes[timer.next].prev = timer.prev;
+                timer.slot = none;
+            }
+
+            /**
+             * @brief Takes every timer out of a slot and places it again relative to the current tick.
+             */
+            void cascade(const uint32_t slot) noexcept {
+                uint32_t index = std::exchange(m_slots[slot], none);
+                while(index != none) {
+                    const uint32_t next = m_nodes[index].next;
+                    place(index);
+                    index = next;
+                }
+            }
+
+            /**
+             * @brief Processes the tick m_tick and moves on to the next one. Expired callbacks are collected into ready.
+             */
+            void process_tick(std::vector<xenon::async::job>& ready) noexcept {
+                const uint64_t tick = m_tick;
+                // Coarser levels are emptied top-down at the start of their block, so their timers land in finer slots before this tick fires
+                if((tick & (level0_slots - 1)) == 0) [[unlikely]] {
+                    uint32_t level = 1;
+                    while(level < levels - 1 && ((tick >> (level0_bits + level_bits * (level - 1))) & (level_slots - 1)) == 0)
+                        ++level;
+                    for(; level >= 1; --level) {
+                        const uint32_t shift = level0_bits + level_bits * (level - 1);
+                        cascade(level0_slots + (level - 1) * level_slots + static_cast<uint32_t>((tick >> shift) & (level_slots - 1)));
+                    }
+                }
+
+                const uint32_t slot = static_cast<uint32_t>(tick & (level0_slots - 1));
+                uint32_t index = std::exchange(m_slots[slot], none);
+                m_tick = tick + 1;
+                while(index != none) {
+                    node& timer = m_nodes[index];
+                    const uint32_t next = timer.next;
+                    if(timer.expiry > tick) [[unlikely]]
+                        place(index);
+                    else if(timer.period == 0) {
+                        ready.emplace_back(std::move(timer.once));
+                        release(index);
+                    } else {
+                        if(!timer.every->running.exchange(true, std::memory_order_acquire))
+                            ready.emplace_back([every = timer.every]() {
+                                every->func();
+                                every->running.store(false, std::memory_order_release);
+                            });
+                        timer.expiry = std::max(timer.expiry + timer.period, m_tick);
+                        place(index);
+                    }
+                    index = next;
+                }
+            }
+
+            /**
+             * @brief Finds the next tick that has to be processed, either an occupied level 0 slot or the start of the next level 0 rotation.
+             */
+            [[nodiscard]] uint64_t next_wakeup(void) const noexcept {
+                const uint64_t rotation_end = (m_tick | (level0_slots - 1)) + 1;
+                for(uint64_t tick = m_tick; tick < rotation_end; ++tick)
+                    if(m_slots[tick & (level0_slots - 1)] != none)
+                        return tick;
+                return rotation_end;
+            }
+
+            void run(void) noexcept {
+                std::vector<xenon::async::job> ready;
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while(!m_stopping) {
+                    for(const uint64_t now = now_tick(); m_tick <= now;)
+                        process_tick(ready);
+
+                    if(!ready.empty()) {
+                        lock.unlock();
+                        for(xenon::async::job& work : ready)
+                            m_pool.submit(std::move(work));
+                        ready.clear();
+                        lock.lock();
+                        continue;
+                    }
+
+                    if(m_count == 0) {
+                        m_wakeup = static_cast<uint64_t>(-1);
+                        m_cv.wait(lock, [this]() { return m_stopping || m_count != 0; });
+                    } else {
+                        m_wakeup = next_wakeup();
+                        m_cv.wait_until(lock, m_start + std::chrono::milliseconds(m_wakeup));
+                    }
+                    m_wakeup = 0;
+                }
+            }
+
+            xenon::async::thread_pool& m_pool;
+            const std::chrono::steady_clock::time_point m_start;
+
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+            bool m_stopping = false;
+
+            std::vector<node> m_nodes;
+            uint32_t m_slots[level0_slots + (levels - 1) * level_slots];
+            uint32_t m_free = none;
+            size_t m_count = 0;
+            uint64_t m_tick = 0;
+            uint64_t m_wakeup = 0;
+
+            std::thread m_thread;
+        };
+
+        /**
+         * @brief Gets the global scheduler that asynchronous timeouts and intervals use. Runs callbacks on the default thread pool.
+         * @note   The scheduler is never destroyed, just like the default pool.
+         * @retval The default scheduler
+         */
+        [[nodiscard]] inline timer_scheduler& default_scheduler(void) noexcept {
+            static timer_scheduler* scheduler = new timer_scheduler();
+            return *scheduler;
+        }
+    } // namespace time
+} // namespace xenon
+
+#endif // XENON_HG_TIME_SCHEDULER
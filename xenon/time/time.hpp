@@ -7,41 +7,49 @@
 
 // Libraries
 #include <memory>
+#include <coroutine>
+#include <thread>
+#include <chrono>
 
 // Other parts of the Time component
 #include "clock.hpp"
+#include "fast_clock.hpp"
+#include "histogram.hpp"
+#include "scheduler.hpp"
 #include "interval.hpp"
 
 // Dependencies
 #include "../async/async.hpp"
 
-namespace {
-    // -- Helper functions. Should not be used by the user. -- \\ 
-
-    template<typename F, typename... Args>
-        requires xenon::concepts::callable<F, Args...>
-    inline void XENON_HF_set_timeout(F&& func, const uint32_t delay_ms, const bool async, Args&&... args) noexcept {
-        const auto function = [&func, delay_ms]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-            func(std::forward<Args>(args)...);
-        };
-        async ? xenon::async::run<void>(function) : function();
-    }
-}
-
 namespace xenon {
     namespace time {
         /**
          * @brief Waits the timeout and then runs the function(asynchronously). 
-         * @note   
+         * @note   No thread waits for the timeout, the default scheduler runs the function on the default pool once it expires.
          * @param  func: The function
          * @param  timeout: After how many milliseconds to run the function
          * @param  args: Args
-         * @retval None
+         * @retval An identifier that can be given to clear_timeout
          */
         template<typename F, typename... Args>
-        inline void set_async_timeout(F&& func, const uint32_t timeout, Args&&... args) noexcept {
-            XENON_HF_set_timeout(std::forward<F>(func), timeout, true, std::forward<Args>(args)...);
+            requires xenon::concepts::callable<F, Args...>
+        inline timer_id set_async_timeout(F&& func, const uint32_t timeout, Args&&... args) noexcept {
+            if constexpr(sizeof...(Args) == 0)
+                return xenon::time::default_scheduler().schedule(timeout, std::forward<F>(func));
+            else
+                return xenon::time::default_scheduler().schedule(timeout, [func = std::forward<F>(func), ... args = std::forward<Args>(args)]() mutable {
+                    func(std::move(args)...);
+                });
+        }
+
+        /**
+         * @brief Cancels a timeout that was set with set_async_timeout.
+         * @note   
+         * @param  id: The identifier that set_async_timeout returned
+         * @retval True if the timeout hadn't run yet
+         */
+        inline bool clear_timeout(const timer_id id) noexcept {
+            return xenon::time::default_scheduler().cancel(id);
         }
 
         /**
@@ -53,8 +61,33 @@ namespace xenon {
          * @retval None
          */
         template<typename F, typename... Args>
+            requires xenon::concepts::callable<F, Args...>
         inline void set_sync_timeout(F&& func, const uint32_t timeout, Args&&... args) noexcept {
-            XENON_HF_set_timeout(std::forward<F>(func), timeout, false, std::forward<Args>(args)...);
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            func(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Suspends the awaiting coroutine for some time without holding a thread, then resumes it on the default pool.
+         * @note   Use as co_await xenon::time::delay(100);
+         * @param  timeout: How many milliseconds to wait
+         * @retval An awaiter
+         */
+        [[nodiscard]] inline auto delay(const uint32_t timeout) noexcept {
+            struct awaiter {
+                uint32_t m_timeout;
+
+                bool await_ready(void) noexcept {
+                    return m_timeout == 0;
+                }
+
+                void await_suspend(const std::coroutine_handle<> handle) noexcept {
+                    xenon::time::set_async_timeout([handle]() { handle.resume(); }, m_timeout);
+                }
+
+                void await_resume(void) noexcept {}
+            };
+            return awaiter{ timeout };
         }
 
         /**
@@ -70,6 +103,20 @@ namespace xenon {
             return std::make_unique<interval<F, Args...>>(std::forward<F>(func), timeout, true, std::forward<Args>(args)...);
         }
 
+        /**
+         * @brief Every single waited timeout the function is gonna be asynchronously called.
+         * @note   
+         * @param  policy: What to do with deadlines that were missed because the function ran late
+         * @param  func: The function
+         * @param  timeout: The amount of milliseconds between each interval
+         * @param  args: Args
+         * @retval 
+         */
+        template<typename F, typename... Args>
+        std::unique_ptr<interval<F, Args...>> set_async_interval(const catch_up policy, F&& func, const uint32_t timeout, Args&&... args) noexcept {
+            return std::make_unique<interval<F, Args...>>(std::forward<F>(func), timeout, true, policy, std::forward<Args>(args)...);
+        }
+
         /**
          * @brief Every single waited timeout the function is gonna be synchronously called.
          * @note   
@@ -82,6 +129,20 @@ namespace xenon {
         std::unique_ptr<interval<F, Args...>> set_sync_interval(F&& func, const uint32_t timeout, Args&&... args) noexcept {
             return std::make_unique<interval<F, Args...>>(std::forward<F>(func), timeout, false, std::forward<Args>(args)...);
         }
+
+        /**
+         * @brief Every single waited timeout the function is gonna be synchronously called.
+         * @note   
+         * @param  policy: What to do with deadlines that were missed because the function ran late
+         * @param  func: The function
+         * @param  timeout: The amount of milliseconds between each interval
+         * @param  args: Args
+         * @retval 
+         */
+        template<typename F, typename... Args>
+        std::unique_ptr<interval<F, Args...>> set_sync_interval(const catch_up policy, F&& func, const uint32_t timeout, Args&&... args) noexcept {
+            return std::make_unique<interval<F, Args...>>(std::forward<F>(func), timeout, false, policy, std::forward<Args>(args)...);
+        }
     } // namespace time
 } // namespace xenon
 
@@ -0,0 +1,89 @@
+// cpu.hpp
+//
+// CPU feature detection that is a part of Utilities Module.
+
+#ifndef XENON_HG_UTILITIES_CPU
+#define XENON_HG_UTILITIES_CPU
+
+// Libraries
+#include <cstdint>
+
+#include "../../macros.hpp"
+
+#ifdef XENON_M_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif // _MSC_VER
+#endif // XENON_M_X86
+
+namespace xenon {
+    namespace utilities {
+        /**
+         * @brief Instruction sets that both the CPU and the OS support, for picking a SIMD kernel at runtime.
+         * @note   Everything is false on CPUs that aren't x86.
+         */
+        struct cpu_features {
+            bool sse42 = false;
+            bool pclmul = false;
+            bool avx2 = false;
+            bool bmi2 = false;
+            bool avx512f = false;
+            bool avx512bw = false;
+        };
+
+        /**
+         * @brief Gets the instruction sets of the CPU the program runs on.
+         * @note   Detected once, the first time it's called.
+         * @retval The features
+         */
+        [[nodiscard]] inline const cpu_features& cpu(void) noexcept {
+            static const cpu_features features = []() {
+                cpu_features result;
+#ifdef XENON_M_X86
+                uint32_t leaf1[4] = {}, leaf7[4] = {};
+                uint64_t xcr0 = 0;
+#ifdef _MSC_VER
+                int32_t info[4];
+                __cpuid(info, 0);
+                const uint32_t max_leaf = static_cast<uint32_t>(info[0]);
+                __cpuid(info, 1);
+                for(int32_t i = 0; i < 4; ++i)
+                    leaf1[i] = static_cast<uint32_t>(info[i]);
+                if(max_leaf >= 7) {
+                    __cpuidex(info, 7, 0);
+                    for(int32_t i = 0; i < 4; ++i)
+                        leaf7[i] = static_cast<uint32_t>(info[i]);
+                }
+                if((leaf1[2] >> 27) & 1)
+                    xcr0 = _xgetbv(0);
+#else
+                const uint32_t max_leaf = __get_cpuid_max(0, nullptr);
+                __get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]);
+                if(max_leaf >= 7)
+                    __get_cpuid_count(7, 0, &leaf7[0], &leaf7[1], &leaf7[2], &leaf7[3]);
+                if((leaf1[2] >> 27) & 1) {
+                    uint32_t low, high;
+                    asm volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+                    xcr0 = (static_cast<uint64_t>(high) << 32) | low;
+                }
+#endif // _MSC_VER
+                // The OS has to save the wider registers on context switches too, which it reports in XCR0
+                const bool os_avx = (xcr0 & 0x6) == 0x6;
+                const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+                result.sse42 = (leaf1[2] >> 20) & 1;
+                result.pclmul = (leaf1[2] >> 1) & 1;
+                result.avx2 = os_avx && ((leaf7[1] >> 5) & 1);
+                result.bmi2 = (leaf7[1] >> 8) & 1;
+                result.avx512f = os_avx512 && ((leaf7[1] >> 16) & 1);
+                result.avx512bw = result.avx512f && ((leaf7[1] >> 30) & 1);
+#endif // XENON_M_X86
+                return result;
+            }();
+            return features;
+        }
+    } // namespace utilities
+} // namespace xenon
+
+#endif // XENON_HG_UTILITIES_CPU
@@ -10,5 +10,6 @@
 #include "parts/vector3.hpp"
 #include "parts/vector4.hpp"
 #include "parts/rect.hpp"
+#include "parts/cpu.hpp"
 
 #endif // XENON_HG_UTILIES_MODULE
\ No newline at end of file
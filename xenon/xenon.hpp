@@ -30,6 +30,13 @@ namespace xenon {
 
     } // namespace async
 
+    /**
+     * @brief Module that is able to measure how fast code runs and profile where the time goes.
+     */
+    namespace bench {
+
+    } // namespace bench
+
 #ifdef XENON_M_CPP20GRT
     /**
      * @brief Module that has various concepts and tools that can be used in your regular code instead of SFINAE.
@@ -152,6 +159,7 @@ namespace xenon {
 #include "files/files.hpp"
 #include "random/random.hpp"
 #include "time/time.hpp"
+#include "bench/bench.hpp"
 
 // Windows-only includes
 #ifdef XENON_M_WIN